@@ -0,0 +1,205 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "archive.h"
+
+#include "common.h"
+#include "utils.h"
+
+#include <stdlib.h>
+
+/*
+ * The file format is:
+ *   ARCHIVE_MAGIC, and LevelsIPC as one byte;
+ *   then for each variation: the length of its GraphML, and the GraphML;
+ *   then the offset of each variation;
+ *   then the footer: the offset of the index, the first variation number,
+ *   the number of variations, and ARCHIVE_MAGIC.
+ * Lengths are 32 bits, offsets are 64 bits, all little-endian.
+ */
+#define ARCHIVE_MAGIC "VENNGMA1"
+#define ARCHIVE_MAGIC_LENGTH 8
+#define HEADER_LENGTH (ARCHIVE_MAGIC_LENGTH + 1)
+#define FOOTER_LENGTH (8 + 4 + 4 + ARCHIVE_MAGIC_LENGTH)
+
+THREAD_LOCAL struct archive ArchiveIPC;
+
+static void writeLittleEndian(FILE* fp, uint64 value, int bytes)
+{
+  for (int i = 0; i < bytes; i++, value >>= 8) {
+    putc(value & 0xFF, fp);
+  }
+}
+
+static bool readLittleEndian(FILE* fp, uint64* value, int bytes)
+{
+  *value = 0;
+  for (int i = 0; i < bytes; i++) {
+    int c = getc(fp);
+    if (c == EOF) {
+      return false;
+    }
+    *value |= (uint64)c << (8 * i);
+  }
+  return true;
+}
+
+void archiveBegin(struct archive* archive, FILE* fp, int levels)
+{
+  archive->fp = fp;
+  archive->count = 0;
+  archive->firstVariation = 0;
+  archive->levels = levels;
+  fputs(ARCHIVE_MAGIC, fp);
+  putc(levels, fp);
+  archive->size = HEADER_LENGTH;
+}
+
+void archiveWrite(struct archive* archive, int variationNumber,
+                  const char* data, size_t length)
+{
+  if (archive->count == 0) {
+    archive->firstVariation = variationNumber;
+  }
+  assert((uint32_t)variationNumber == archive->firstVariation + archive->count);
+  if (archive->count == archive->capacity) {
+    archive->capacity = archive->capacity == 0 ? 1024 : 2 * archive->capacity;
+    archive->offsets =
+        realloc(archive->offsets, archive->capacity * sizeof(uint64));
+    if (archive->offsets == NULL) {
+      perror("realloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+  archive->offsets[archive->count++] = archive->size;
+  writeLittleEndian(archive->fp, length, 4);
+  fwrite(data, 1, length, archive->fp);
+  archive->size += 4 + length;
+}
+
+void archiveEnd(struct archive* archive)
+{
+  uint64 indexOffset = archive->size;
+  for (uint32_t i = 0; i < archive->count; i++) {
+    writeLittleEndian(archive->fp, archive->offsets[i], 8);
+  }
+  writeLittleEndian(archive->fp, indexOffset, 8);
+  writeLittleEndian(archive->fp, archive->firstVariation, 4);
+  writeLittleEndian(archive->fp, archive->count, 4);
+  fputs(ARCHIVE_MAGIC, archive->fp);
+  if (fclose(archive->fp) != 0) {
+    perror("Failed to write archive");
+    exit(EXIT_FAILURE);
+  }
+  archive->fp = NULL;
+}
+
+bool archiveOpen(struct archive* archive, FILE* fp)
+{
+  char magic[ARCHIVE_MAGIC_LENGTH];
+  uint64 indexOffset, firstVariation, count;
+  int levels;
+  memset(archive, 0, sizeof(*archive));
+  if (fread(magic, 1, ARCHIVE_MAGIC_LENGTH, fp) != ARCHIVE_MAGIC_LENGTH ||
+      memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_LENGTH) != 0 ||
+      (levels = getc(fp)) == EOF ||
+      fseek(fp, -FOOTER_LENGTH, SEEK_END) != 0 ||
+      !readLittleEndian(fp, &indexOffset, 8) ||
+      !readLittleEndian(fp, &firstVariation, 4) ||
+      !readLittleEndian(fp, &count, 4) ||
+      fread(magic, 1, ARCHIVE_MAGIC_LENGTH, fp) != ARCHIVE_MAGIC_LENGTH ||
+      memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_LENGTH) != 0 ||
+      fseek(fp, indexOffset, SEEK_SET) != 0) {
+    return false;
+  }
+  archive->fp = fp;
+  archive->levels = levels;
+  archive->firstVariation = firstVariation;
+  archive->offsets = malloc((count + 1) * sizeof(uint64));
+  if (archive->offsets == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  archive->capacity = count;
+  for (archive->count = 0; archive->count < count; archive->count++) {
+    if (!readLittleEndian(fp, &archive->offsets[archive->count], 8)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+char* archiveRead(struct archive* archive, int variationNumber,
+                  size_t* length)
+{
+  uint32_t index = variationNumber - archive->firstVariation;
+  uint64 recordLength;
+  char* result;
+  if (variationNumber < (int)archive->firstVariation ||
+      index >= archive->count ||
+      fseek(archive->fp, archive->offsets[index], SEEK_SET) != 0 ||
+      !readLittleEndian(archive->fp, &recordLength, 4)) {
+    return NULL;
+  }
+  result = malloc(recordLength + 1);
+  if (result == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  if (fread(result, 1, recordLength, archive->fp) != recordLength) {
+    free(result);
+    return NULL;
+  }
+  result[recordLength] = '\0';
+  *length = recordLength;
+  return result;
+}
+
+void archiveClose(struct archive* archive)
+{
+  fclose(archive->fp);
+  free(archive->offsets);
+  memset(archive, 0, sizeof(*archive));
+}
+
+void archiveExpand(const char* filename)
+{
+  struct archive archive;
+  size_t length = strlen(filename);
+  size_t extensionLength = strlen(ARCHIVE_EXTENSION);
+  FILE* fp;
+  if (length <= extensionLength ||
+      strcmp(filename + length - extensionLength, ARCHIVE_EXTENSION) != 0 ||
+      length - extensionLength >= sizeof(CurrentPrefixIPC)) {
+    fprintf(stderr, "%s: expected a " ARCHIVE_EXTENSION " file\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  if (!archiveOpen(&archive, fp)) {
+    fprintf(stderr, "%s: not a valid archive\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  snprintf(CurrentPrefixIPC, sizeof(CurrentPrefixIPC), "%.*s",
+           (int)(length - extensionLength), filename);
+  GraphmlFileOps.initializeFolder(CurrentPrefixIPC);
+  LevelsIPC = archive.levels;
+  for (uint32_t i = 0; i < archive.count; i++) {
+    size_t dataLength;
+    VariationNumberIPC = archive.firstVariation + i;
+    char* data = archiveRead(&archive, VariationNumberIPC, &dataLength);
+    if (data == NULL) {
+      fprintf(stderr, "%s: variation %d is truncated\n", filename,
+              VariationNumberIPC);
+      exit(EXIT_FAILURE);
+    }
+    FILE* out = GraphmlFileOps.fopen(graphmlVariationFilename(), "w");
+    fwrite(data, 1, dataLength, out);
+    fclose(out);
+    free(data);
+    freeAll();
+  }
+  archiveClose(&archive);
+}
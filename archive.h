@@ -0,0 +1,53 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "core.h"
+
+/**
+ * An alternative to writing each variation to a GraphML file of its own (-a).
+ * Each solution has one append-only file, <solution>.gma, holding the GraphML
+ * of each variation as a length-prefixed record. When the solution is
+ * finished, an index of the offsets of the records, and a fixed size footer,
+ * are appended, so that any one variation can be read with a single seek.
+ */
+
+#define ARCHIVE_EXTENSION ".gma"
+
+struct archive {
+  FILE* fp;
+  uint64 size;              /* Bytes written so far */
+  uint64* offsets;          /* Offset of each record */
+  uint32_t count;           /* Number of records */
+  uint32_t capacity;        /* Allocated size of offsets */
+  uint32_t firstVariation;  /* Variation number of the first record */
+  int levels;               /* LevelsIPC of the solution */
+};
+
+/* The archive of the current solution, with -a */
+extern THREAD_LOCAL struct archive ArchiveIPC;
+
+/* Writing: the header, each variation in order, and then the index */
+extern void archiveBegin(struct archive* archive, FILE* fp, int levels);
+extern void archiveWrite(struct archive* archive, int variationNumber,
+                         const char* data, size_t length);
+extern void archiveEnd(struct archive* archive);
+
+/**
+ * Reading: archiveOpen reads the header, footer and index, and returns false
+ * if fp is not an archive. archiveRead returns the GraphML of the variation,
+ * allocated with malloc, or NULL if it is not in the archive.
+ */
+extern bool archiveOpen(struct archive* archive, FILE* fp);
+extern char* archiveRead(struct archive* archive, int variationNumber,
+                         size_t* length);
+extern void archiveClose(struct archive* archive);
+
+/**
+ * Writes the GraphML files of the variations in a .gma file, in the same
+ * places as without -a.
+ */
+extern void archiveExpand(const char* filename);
+
+#endif /* ARCHIVE_H */
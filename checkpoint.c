@@ -0,0 +1,172 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "checkpoint.h"
+
+#include "common.h"
+#include "engine.h"
+#include "main.h"
+#include "statistics.h"
+#include "visible_for_testing.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * A checkpoint file is text: a "#checkpoint length" line; a "#call round
+ * choice predicate" line for each entry of the path; a "#solution" line
+ * with the counters that number the solutions; and the statistics, as
+ * written by statisticWriteTotals. It is written to a temporary file, which
+ * is then renamed, so that a crash while writing leaves the previous
+ * checkpoint.
+ */
+#define CHECKPOINT_SECONDS 60
+/* The calls of checkpointMaybeWrite between looking at the clock. */
+#define CHECKPOINT_FREQUENCY 1000
+#define MAX_LINE 4096
+
+static struct choicePoint Path[MAX_STACK_SIZE];
+static int PathLength = 0;
+/* The statistics lines of the checkpoint being resumed. */
+static char** Totals = NULL;
+static int NumberOfTotals = 0;
+static uint64 SolutionsFound;
+static int SolutionNumber;
+static int VariationCount;
+int CheckpointSeconds = CHECKPOINT_SECONDS;
+static time_t LastCheckpoint;
+static int CountDown = CHECKPOINT_FREQUENCY;
+
+static void badCheckpoint(const char* filename, const char* line)
+{
+  fprintf(stderr, "%s: not a checkpoint: %s", filename, line);
+  exit(EXIT_FAILURE);
+}
+
+static void readPath(FILE* file, const char* filename)
+{
+  char line[MAX_LINE];
+  int length;
+  if (fgets(line, sizeof(line), file) == NULL ||
+      sscanf(line, "#checkpoint %d", &PathLength) != 1 || PathLength < 1 ||
+      PathLength > MAX_STACK_SIZE) {
+    badCheckpoint(filename, line);
+  }
+  for (int i = 0; i < PathLength; i++) {
+    if (fgets(line, sizeof(line), file) == NULL ||
+        sscanf(line, "#call %d %d %n", &Path[i].round, &Path[i].choice,
+               &length) != 2) {
+      badCheckpoint(filename, line);
+    }
+    Path[i].predicate = strndup(line + length, strcspn(line + length, "\n"));
+  }
+  if (fgets(line, sizeof(line), file) == NULL ||
+      sscanf(line, "#solution %llu %d %d", &SolutionsFound, &SolutionNumber,
+             &VariationCount) != 3) {
+    badCheckpoint(filename, line);
+  }
+}
+
+static void readTotals(FILE* file)
+{
+  char line[MAX_LINE];
+  while (NumberOfTotals > 0) {
+    free(Totals[--NumberOfTotals]);
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    Totals = realloc(Totals, (NumberOfTotals + 1) * sizeof(char*));
+    if (Totals == NULL) {
+      perror("realloc");
+      exit(EXIT_FAILURE);
+    }
+    Totals[NumberOfTotals++] = strdup(line);
+  }
+}
+
+static void restoreCounters(void)
+{
+  GlobalSolutionsFoundIPC = SolutionsFound;
+  PerFaceDegreeSolutionNumberIPC = SolutionNumber;
+  VariationCountIPC = VariationCount;
+}
+
+/*
+ * At the end of the path. Following the path has counted some of the
+ * guesses etc. again, so the counters are put back as they were when the
+ * checkpoint was written.
+ */
+static void replayed(void)
+{
+  for (int i = 0; i < NumberOfTotals; i++) {
+    statisticRestoreTotal(Totals[i]);
+  }
+  restoreCounters();
+}
+
+bool checkpointResume(const char* filename)
+{
+  FILE* file = fopen(filename, "r");
+  LastCheckpoint = time(NULL);
+  if (file == NULL) {
+    if (errno == ENOENT) {
+      return false;
+    }
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  readPath(file, filename);
+  readTotals(file);
+  fclose(file);
+  /* So that the predicates on the path see the solutions found so far. */
+  restoreCounters();
+  engineReplay(Path, PathLength, replayed);
+  return true;
+}
+
+void checkpointMaybeWrite(void)
+{
+  if (--CountDown > 0) {
+    return;
+  }
+  CountDown = CHECKPOINT_FREQUENCY;
+  if (difftime(time(NULL), LastCheckpoint) >= CheckpointSeconds) {
+    checkpointWrite(CheckpointFileFlag);
+  }
+}
+
+void checkpointWrite(const char* filename)
+{
+  char temporary[strlen(filename) + 5];
+  FILE* file;
+  struct choicePoint path[MAX_STACK_SIZE];
+  int length = enginePath(path);
+  sprintf(temporary, "%s.tmp", filename);
+  file = fopen(temporary, "w");
+  if (file == NULL) {
+    perror(temporary);
+    exit(EXIT_FAILURE);
+  }
+  fprintf(file, "#checkpoint %d\n", length);
+  for (int i = 0; i < length; i++) {
+    fprintf(file, "#call %d %d %s\n", path[i].round, path[i].choice,
+            path[i].predicate);
+  }
+  fprintf(file, "#solution %llu %d %d\n", GlobalSolutionsFoundIPC,
+          PerFaceDegreeSolutionNumberIPC, VariationCountIPC);
+  statisticWriteTotals(file);
+  if (fflush(file) != 0 || fsync(fileno(file)) != 0 || fclose(file) != 0 ||
+      rename(temporary, filename) != 0) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  LastCheckpoint = time(NULL);
+}
+
+void checkpointFinish(const char* filename)
+{
+  if (remove(filename) != 0 && errno != ENOENT) {
+    perror(filename);
+  }
+}
@@ -0,0 +1,31 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "core.h"
+
+/**
+ * Checkpoints of a long search (-r file). Every minute or so, at a call of
+ * the Venn predicate, the path of the engine stack, see enginePath, is
+ * written to the file, with the counters. A later run with the same options
+ * and the same file follows the path back to that call, see engineReplay,
+ * and carries on searching: the subtrees already searched are skipped, and
+ * the solutions keep their numbers. The file is removed when the search
+ * completes.
+ */
+
+/* If filename exists, makes the engine resume from it, and returns true. */
+extern bool checkpointResume(const char* filename);
+
+/* Called at each call of the Venn predicate; writes a checkpoint to
+ * CheckpointFileFlag when one is due. */
+extern void checkpointMaybeWrite(void);
+
+/* Writes the current state of the search to filename. */
+extern void checkpointWrite(const char* filename);
+
+/* Called when the search is complete. */
+extern void checkpointFinish(const char* filename);
+
+#endif  // CHECKPOINT_H
@@ -19,21 +19,24 @@
  */
 
 /* Solution tracking */
-extern uint64 GlobalVariantCountIPC;   /* Total variant count */
-extern uint64 GlobalSolutionsFoundIPC; /* Total solutions found */
-extern int
+extern THREAD_LOCAL uint64 GlobalVariantCountIPC;   /* Total variant count */
+extern THREAD_LOCAL uint64 GlobalSolutionsFoundIPC; /* Total solutions found */
+extern THREAD_LOCAL int
     PerFaceDegreeSolutionNumberIPC; /* Solution number for current face set */
 
 /* Search state */
-extern uint64 CycleGuessCounterIPC; /* Number of cycle guesses */
-extern int VariationCountIPC;  /* Number of variations for current solution */
-extern int VariationNumberIPC; /* Current variation being processed */
-extern int LevelsIPC;          /* Current recursion depth */
+extern THREAD_LOCAL uint64 CycleGuessCounterIPC; /* Number of cycle guesses */
+extern THREAD_LOCAL int
+    VariationCountIPC; /* Number of variations for current solution */
+extern THREAD_LOCAL int
+    VariationNumberIPC;            /* Current variation being processed */
+extern THREAD_LOCAL int LevelsIPC; /* Current recursion depth */
 
 /* Output state */
-extern EDGE SelectedCornersIPC[NCOLORS]
-                              [3];  /* Selected corner edges for output */
-extern char CurrentPrefixIPC[1024]; /* Current output path prefix */
+extern THREAD_LOCAL char
+    CurrentPrefixIPC[1024]; /* Current output path prefix */
+extern THREAD_LOCAL FILE*
+    CompactFileIPC; /* The .var file of the current solution, with -c */
 
 /**
  * File I/O abstraction for GraphML output.
@@ -53,4 +56,20 @@ extern struct graphmlFileIO GraphmlFileOps;
  */
 extern int numberOfLevels(int expectedVariations);
 
+/* The number of variations of the current solution */
+extern int searchCountVariations(void);
+
+/* The number of variations of the current solution that are not rejected
+ * for crossing lines, without enumerating them (-C) */
+extern uint64 cornersCountVariations(void);
+
+/* Writes variation VariationNumberIPC of the current solution as GraphML */
+extern void graphmlWriteVariation(EDGE (*corners)[3]);
+
+/* Writes the XML declaration and GraphML keys that start each variation */
+extern void graphmlBegin(FILE* fp);
+
+/* The GraphML file name of variation VariationNumberIPC, making its folders */
+extern char* graphmlVariationFilename(void);
+
 #endif /* COMMON_H */
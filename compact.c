@@ -0,0 +1,171 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "compact.h"
+
+#include "common.h"
+#include "context.h"
+#include "utils.h"
+
+#include <stdlib.h>
+
+/*
+ * The file format is:
+ *   COMPACT_MAGIC, NCOLORS as one byte, and then the cycle id of each face;
+ *   then for each variation: its number and its corners, in the order of
+ *   Context.selectedCorners.
+ * Cycle ids and corners are 16 bits, variation numbers are 32 bits, all
+ * little-endian, so a variation takes 4 + 3 * NCOLORS * 2 bytes, i.e. 40.
+ * A corner is the index of the edge, see edgeId.
+ */
+#define COMPACT_MAGIC "VENNVAR1"
+#define COMPACT_MAGIC_LENGTH 8
+#define NO_CORNER 0xFFFF
+
+static void writeUint16(FILE *fp, uint32_t value)
+{
+  putc(value & 0xFF, fp);
+  putc((value >> 8) & 0xFF, fp);
+}
+
+static bool readUint16(FILE *fp, uint32_t *value)
+{
+  int low = getc(fp);
+  int high = getc(fp);
+  if (low == EOF || high == EOF) {
+    return false;
+  }
+  *value = (uint32_t)low | (uint32_t)high << 8;
+  return true;
+}
+
+static uint32_t edgeId(EDGE edge)
+{
+  return edge == NULL ? NO_CORNER : edge->colors * NCOLORS + edge->color;
+}
+
+static EDGE edgeFromId(uint32_t id)
+{
+  return id == NO_CORNER ? NULL : &Faces[id / NCOLORS].edges[id % NCOLORS];
+}
+
+void compactWriteSolution(FILE *fp)
+{
+  fputs(COMPACT_MAGIC, fp);
+  putc(NCOLORS, fp);
+  for (uint32_t i = 0; i < NFACES; i++) {
+    assert(Context.faces[i].cycle != NULL);
+    writeUint16(fp, Context.faces[i].cycle - Cycles);
+  }
+}
+
+void compactWriteVariation(FILE *fp, int variationNumber, EDGE (*corners)[3])
+{
+  writeUint16(fp, variationNumber & 0xFFFF);
+  writeUint16(fp, variationNumber >> 16);
+  for (COLOR a = 0; a < NCOLORS; a++) {
+    for (int i = 0; i < 3; i++) {
+      writeUint16(fp, edgeId(corners[a][i]));
+    }
+  }
+}
+
+/*
+ * Chooses the given cycle for the face, unless the earlier choices have
+ * already done so.
+ */
+static bool dynamicRestoreFace(FACE face, uint32_t cycleId)
+{
+  struct faceState *state = FACE_STATE(face);
+  if (state->cycle != NULL) {
+    return state->cycle == Cycles + cycleId;
+  }
+  if (!cycleSetMember(cycleId, state->possibleCycles)) {
+    return false;
+  }
+  TRAIL_SET_POINTER(&state->cycle, Cycles + cycleId);
+  return dynamicFaceBacktrackableChoice(face) == NULL;
+}
+
+/**
+ * Reads the header of a .var file, and makes the same choice of cycle for
+ * each face as in the solution. Returns false if the file is not valid.
+ */
+bool dynamicCompactReadSolution(FILE *fp)
+{
+  char magic[COMPACT_MAGIC_LENGTH];
+  uint32_t cycleIds[NFACES];
+  if (fread(magic, 1, COMPACT_MAGIC_LENGTH, fp) != COMPACT_MAGIC_LENGTH ||
+      memcmp(magic, COMPACT_MAGIC, COMPACT_MAGIC_LENGTH) != 0 ||
+      getc(fp) != NCOLORS) {
+    return false;
+  }
+  for (uint32_t i = 0; i < NFACES; i++) {
+    if (!readUint16(fp, &cycleIds[i]) || cycleIds[i] >= NCYCLES) {
+      return false;
+    }
+  }
+  /* The corner checks expect the central face to be chosen first. */
+  for (uint32_t i = NFACES; i-- > 0;) {
+    if (!dynamicRestoreFace(Faces + i, cycleIds[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Reads the next variation of a .var file into corners, and returns its
+ * number, or 0 at the end of the file.
+ */
+int compactReadVariation(FILE *fp, EDGE (*corners)[3])
+{
+  uint32_t low, high, id;
+  if (!readUint16(fp, &low) || !readUint16(fp, &high)) {
+    return 0;
+  }
+  for (COLOR a = 0; a < NCOLORS; a++) {
+    for (int i = 0; i < 3; i++) {
+      if (!readUint16(fp, &id) ||
+          (id != NO_CORNER && id >= NFACES * NCOLORS)) {
+        return 0;
+      }
+      corners[a][i] = edgeFromId(id);
+    }
+  }
+  return (int)(low | high << 16);
+}
+
+void compactExpand(const char *filename, int variationNumber)
+{
+  EDGE corners[NCOLORS][3];
+  size_t length = strlen(filename);
+  size_t extensionLength = strlen(COMPACT_EXTENSION);
+  FILE *fp;
+  if (length <= extensionLength ||
+      strcmp(filename + length - extensionLength, COMPACT_EXTENSION) != 0 ||
+      length - extensionLength >= sizeof(CurrentPrefixIPC)) {
+    fprintf(stderr, "%s: expected a " COMPACT_EXTENSION " file\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  initialize();
+  if (!dynamicCompactReadSolution(fp)) {
+    fprintf(stderr, "%s: not a valid variations file\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  snprintf(CurrentPrefixIPC, sizeof(CurrentPrefixIPC), "%.*s",
+           (int)(length - extensionLength), filename);
+  GraphmlFileOps.initializeFolder(CurrentPrefixIPC);
+  LevelsIPC = numberOfLevels(searchCountVariations());
+  while ((VariationNumberIPC = compactReadVariation(fp, corners)) != 0) {
+    if (variationNumber == 0 || variationNumber == VariationNumberIPC) {
+      graphmlWriteVariation(corners);
+    }
+    freeAll();
+  }
+  fclose(fp);
+}
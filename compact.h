@@ -0,0 +1,34 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include "face.h"
+
+/**
+ * A compact binary alternative to writing each variation as a GraphML file
+ * (-c). Each solution has one file, <solution>.var, which starts with the
+ * facial cycles of the solution, followed by one short record per variation:
+ * the variation number and its 3 * NCOLORS corners.
+ * Such a file can be expanded back into exactly the GraphML files that would
+ * otherwise have been written (-x).
+ */
+
+#define COMPACT_EXTENSION ".var"
+
+/* Writing: the header for the current solution, then each variation */
+extern void compactWriteSolution(FILE *fp);
+extern void compactWriteVariation(FILE *fp, int variationNumber,
+                                  EDGE (*corners)[3]);
+
+/* Reading: restores the solution (on the trail), then each variation */
+extern bool dynamicCompactReadSolution(FILE *fp);
+extern int compactReadVariation(FILE *fp, EDGE (*corners)[3]);
+
+/**
+ * Writes the GraphML files of the variations in a .var file, or just
+ * of one variation, if variationNumber is not 0.
+ */
+extern void compactExpand(const char *filename, int variationNumber);
+
+#endif /* COMPACT_H */
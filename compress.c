@@ -0,0 +1,286 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "compress.h"
+
+#include "common.h"
+#include "utils.h"
+
+#include <stdlib.h>
+
+/*
+ * The file format is:
+ *   COMPRESS_MAGIC, LevelsIPC as one byte, and the length of the text that
+ *   is in the dictionary, as 32 bits;
+ *   then a zlib stream, with a preset dictionary, of each variation: its
+ *   number and the length of its GraphML, both 32 bits, and the GraphML.
+ * All numbers are little-endian.
+ */
+#define COMPRESS_MAGIC "VENNGMZ1"
+#define COMPRESS_MAGIC_LENGTH 8
+#define RECORD_HEADER_LENGTH 8
+#define CHUNK 16384
+
+THREAD_LOCAL struct compressor CompressorIPC;
+
+static void putLittleEndian(unsigned char* buffer, uint64 value, int bytes)
+{
+  for (int i = 0; i < bytes; i++, value >>= 8) {
+    buffer[i] = value & 0xFF;
+  }
+}
+
+static uint64 getLittleEndian(const unsigned char* buffer, int bytes)
+{
+  uint64 result = 0;
+  for (int i = 0; i < bytes; i++) {
+    result |= (uint64)buffer[i] << (8 * i);
+  }
+  return result;
+}
+
+/*
+ * The first textLength bytes of the text file, and then the GraphML header,
+ * which starts every variation. Returned as malloc'ed memory.
+ */
+static char* buildDictionary(const char* textFilename, size_t textLength,
+                             size_t* length)
+{
+  char* result;
+  char buffer[CHUNK];
+  size_t remaining = textLength;
+  FILE* text = fopen(textFilename, "r");
+  FILE* fp = open_memstream(&result, length);
+  if (text == NULL || fp == NULL) {
+    perror(textFilename);
+    exit(EXIT_FAILURE);
+  }
+  while (remaining > 0) {
+    size_t n = fread(buffer, 1, remaining < CHUNK ? remaining : CHUNK, text);
+    if (n == 0) {
+      fprintf(stderr, "%s: shorter than expected\n", textFilename);
+      exit(EXIT_FAILURE);
+    }
+    fwrite(buffer, 1, n, fp);
+    remaining -= n;
+  }
+  fclose(text);
+  graphmlBegin(fp);
+  fclose(fp);
+  return result;
+}
+
+static void deflateChunk(struct compressor* compressor, const void* data,
+                         size_t length, int flush)
+{
+  unsigned char out[CHUNK];
+  z_stream* stream = &compressor->stream;
+  stream->next_in = (Bytef*)data;
+  stream->avail_in = length;
+  do {
+    stream->next_out = out;
+    stream->avail_out = CHUNK;
+    if (deflate(stream, flush) == Z_STREAM_ERROR) {
+      fprintf(stderr, "deflate failed\n");
+      exit(EXIT_FAILURE);
+    }
+    fwrite(out, 1, CHUNK - stream->avail_out, compressor->fp);
+  } while (stream->avail_out == 0);
+}
+
+static void* compressThread(void* arg)
+{
+  struct compressor* compressor = arg;
+  unsigned char header[RECORD_HEADER_LENGTH];
+  for (;;) {
+    struct compressTask task;
+    pthread_mutex_lock(&compressor->mutex);
+    while (compressor->count == 0 && !compressor->closing) {
+      pthread_cond_wait(&compressor->notEmpty, &compressor->mutex);
+    }
+    if (compressor->count == 0) {
+      pthread_mutex_unlock(&compressor->mutex);
+      break;
+    }
+    task = compressor->queue[compressor->head];
+    compressor->head = (compressor->head + 1) % COMPRESS_QUEUE_LENGTH;
+    compressor->count--;
+    pthread_cond_signal(&compressor->notFull);
+    pthread_mutex_unlock(&compressor->mutex);
+
+    putLittleEndian(header, task.variationNumber, 4);
+    putLittleEndian(header + 4, task.length, 4);
+    deflateChunk(compressor, header, RECORD_HEADER_LENGTH, Z_NO_FLUSH);
+    deflateChunk(compressor, task.data, task.length, Z_NO_FLUSH);
+    free(task.data);
+  }
+  deflateChunk(compressor, NULL, 0, Z_FINISH);
+  return NULL;
+}
+
+void compressBegin(struct compressor* compressor, FILE* fp, int levels,
+                   const char* textFilename, size_t textLength)
+{
+  unsigned char header[4];
+  size_t dictionaryLength;
+  char* dictionary =
+      buildDictionary(textFilename, textLength, &dictionaryLength);
+  compressor->fp = fp;
+  fputs(COMPRESS_MAGIC, fp);
+  putc(levels, fp);
+  putLittleEndian(header, textLength, 4);
+  fwrite(header, 1, 4, fp);
+
+  memset(&compressor->stream, 0, sizeof(compressor->stream));
+  if (deflateInit(&compressor->stream, Z_DEFAULT_COMPRESSION) != Z_OK ||
+      deflateSetDictionary(&compressor->stream, (Bytef*)dictionary,
+                           dictionaryLength) != Z_OK) {
+    fprintf(stderr, "deflateInit failed\n");
+    exit(EXIT_FAILURE);
+  }
+  free(dictionary);
+
+  compressor->head = 0;
+  compressor->count = 0;
+  compressor->closing = false;
+  pthread_mutex_init(&compressor->mutex, NULL);
+  pthread_cond_init(&compressor->notEmpty, NULL);
+  pthread_cond_init(&compressor->notFull, NULL);
+  if (pthread_create(&compressor->thread, NULL, compressThread, compressor) !=
+      0) {
+    perror("pthread_create");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void compressWrite(struct compressor* compressor, int variationNumber,
+                   char* data, size_t length)
+{
+  pthread_mutex_lock(&compressor->mutex);
+  while (compressor->count == COMPRESS_QUEUE_LENGTH) {
+    pthread_cond_wait(&compressor->notFull, &compressor->mutex);
+  }
+  compressor->queue[(compressor->head + compressor->count) %
+                    COMPRESS_QUEUE_LENGTH] =
+      (struct compressTask){data, length, variationNumber};
+  compressor->count++;
+  pthread_cond_signal(&compressor->notEmpty);
+  pthread_mutex_unlock(&compressor->mutex);
+}
+
+void compressEnd(struct compressor* compressor)
+{
+  pthread_mutex_lock(&compressor->mutex);
+  compressor->closing = true;
+  pthread_cond_signal(&compressor->notEmpty);
+  pthread_mutex_unlock(&compressor->mutex);
+  pthread_join(compressor->thread, NULL);
+  deflateEnd(&compressor->stream);
+  pthread_mutex_destroy(&compressor->mutex);
+  pthread_cond_destroy(&compressor->notEmpty);
+  pthread_cond_destroy(&compressor->notFull);
+  if (fclose(compressor->fp) != 0) {
+    perror("Failed to write compressed file");
+    exit(EXIT_FAILURE);
+  }
+  compressor->fp = NULL;
+}
+
+struct decompressor {
+  FILE* fp;
+  z_stream stream;
+  unsigned char in[CHUNK];
+  char* dictionary;
+  size_t dictionaryLength;
+};
+
+/* Returns the number of bytes read, less than length only at the end. */
+static size_t inflateExactly(struct decompressor* decompressor, void* buffer,
+                             size_t length)
+{
+  z_stream* stream = &decompressor->stream;
+  stream->next_out = buffer;
+  stream->avail_out = length;
+  while (stream->avail_out > 0) {
+    if (stream->avail_in == 0) {
+      stream->avail_in = fread(decompressor->in, 1, CHUNK, decompressor->fp);
+      stream->next_in = decompressor->in;
+    }
+    switch (inflate(stream, Z_NO_FLUSH)) {
+      case Z_OK:
+        break;
+      case Z_NEED_DICT:
+        if (inflateSetDictionary(stream, (Bytef*)decompressor->dictionary,
+                                 decompressor->dictionaryLength) != Z_OK) {
+          fprintf(stderr, "The text file does not match the dictionary\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case Z_STREAM_END:
+        return length - stream->avail_out;
+      default: /* Including a truncated file */
+        fprintf(stderr, "Corrupt compressed data\n");
+        exit(EXIT_FAILURE);
+    }
+  }
+  return length;
+}
+
+void compressExpand(const char* filename)
+{
+  struct decompressor decompressor;
+  unsigned char header[COMPRESS_MAGIC_LENGTH + 1 + 4];
+  unsigned char recordHeader[RECORD_HEADER_LENGTH];
+  char textFilename[sizeof(CurrentPrefixIPC) + 4];
+  size_t length = strlen(filename);
+  size_t extensionLength = strlen(COMPRESS_EXTENSION);
+  if (length <= extensionLength ||
+      strcmp(filename + length - extensionLength, COMPRESS_EXTENSION) != 0 ||
+      length - extensionLength >= sizeof(CurrentPrefixIPC)) {
+    fprintf(stderr, "%s: expected a " COMPRESS_EXTENSION " file\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  memset(&decompressor, 0, sizeof(decompressor));
+  decompressor.fp = fopen(filename, "rb");
+  if (decompressor.fp == NULL) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  if (fread(header, 1, sizeof(header), decompressor.fp) != sizeof(header) ||
+      memcmp(header, COMPRESS_MAGIC, COMPRESS_MAGIC_LENGTH) != 0 ||
+      inflateInit(&decompressor.stream) != Z_OK) {
+    fprintf(stderr, "%s: not a valid compressed file\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  snprintf(CurrentPrefixIPC, sizeof(CurrentPrefixIPC), "%.*s",
+           (int)(length - extensionLength), filename);
+  snprintf(textFilename, sizeof(textFilename), "%s.txt", CurrentPrefixIPC);
+  decompressor.dictionary = buildDictionary(
+      textFilename, getLittleEndian(header + COMPRESS_MAGIC_LENGTH + 1, 4),
+      &decompressor.dictionaryLength);
+  GraphmlFileOps.initializeFolder(CurrentPrefixIPC);
+  LevelsIPC = header[COMPRESS_MAGIC_LENGTH];
+  while (inflateExactly(&decompressor, recordHeader, RECORD_HEADER_LENGTH) ==
+         RECORD_HEADER_LENGTH) {
+    size_t dataLength = getLittleEndian(recordHeader + 4, 4);
+    char* data = malloc(dataLength);
+    if (data == NULL) {
+      perror("malloc");
+      exit(EXIT_FAILURE);
+    }
+    VariationNumberIPC = getLittleEndian(recordHeader, 4);
+    if (inflateExactly(&decompressor, data, dataLength) != dataLength) {
+      fprintf(stderr, "%s: variation %d is truncated\n", filename,
+              VariationNumberIPC);
+      exit(EXIT_FAILURE);
+    }
+    FILE* out = GraphmlFileOps.fopen(graphmlVariationFilename(), "w");
+    fwrite(data, 1, dataLength, out);
+    fclose(out);
+    free(data);
+    freeAll();
+  }
+  inflateEnd(&decompressor.stream);
+  free(decompressor.dictionary);
+  fclose(decompressor.fp);
+}
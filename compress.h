@@ -0,0 +1,61 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "core.h"
+
+#include <pthread.h>
+#include <zlib.h>
+
+/**
+ * Compressed output (-z). The GraphML of every variation of a solution is
+ * streamed through one deflate stream into <solution>.gmz. The stream starts
+ * with a preset dictionary: the solution's text file, as it is when the
+ * variations start, followed by the GraphML header. The compression is done
+ * by a thread of its own, so that the search only waits when it is
+ * COMPRESS_QUEUE_LENGTH variations ahead.
+ */
+
+#define COMPRESS_EXTENSION ".gmz"
+#define COMPRESS_QUEUE_LENGTH 64
+
+struct compressor {
+  FILE* fp;
+  z_stream stream;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t notEmpty;
+  pthread_cond_t notFull;
+  struct compressTask {
+    char* data; /* malloc'ed, freed by the compressor thread */
+    size_t length;
+    int variationNumber;
+  } queue[COMPRESS_QUEUE_LENGTH];
+  int head;     /* Next task to compress */
+  int count;    /* Number of tasks queued */
+  bool closing; /* No more tasks will be queued */
+};
+
+/* The compressor of the current solution, with -z */
+extern THREAD_LOCAL struct compressor CompressorIPC;
+
+/**
+ * Starts compressing into fp. textFilename is the text file of the solution,
+ * of which the first textLength bytes are part of the dictionary.
+ */
+extern void compressBegin(struct compressor* compressor, FILE* fp, int levels,
+                          const char* textFilename, size_t textLength);
+/* Queues the GraphML of a variation, taking ownership of data. */
+extern void compressWrite(struct compressor* compressor, int variationNumber,
+                          char* data, size_t length);
+/* Waits for the queue to be compressed, and closes the file. */
+extern void compressEnd(struct compressor* compressor);
+
+/**
+ * Writes the GraphML files of the variations in a .gmz file, in the same
+ * places as without -z. The text file of the solution must be beside it.
+ */
+extern void compressExpand(const char* filename);
+
+#endif /* COMPRESS_H */
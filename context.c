@@ -0,0 +1,49 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "context.h"
+
+THREAD_LOCAL struct searchContext Context;
+
+/* The context after initialization, before any search. */
+static MEMO struct searchContext InitialContext;
+static THREAD_LOCAL bool ContextInitialized = false;
+
+/**
+ * Called once, by the first thread to initialize, after the MEMO data and
+ * its own context have been initialized.
+ */
+void initializeContextSaveInitial(void)
+{
+  InitialContext = Context;
+  ContextInitialized = true;
+}
+
+/**
+ * Starts the context of this thread from the initial context, unless this
+ * thread has already done so.
+ */
+void initializeContext(void)
+{
+  if (!ContextInitialized) {
+    Context = InitialContext;
+    ContextInitialized = true;
+  }
+}
+
+/**
+ * Copies the current search state into clone, e.g. for use in another
+ * thread.
+ */
+void contextClone(SEARCH_CONTEXT clone)
+{
+  memcpy(clone, &Context, sizeof(Context));
+}
+
+/**
+ * Replaces the current search state with a clone. This does not use the
+ * trail: it is for threads that are not searching.
+ */
+void contextRestore(SEARCH_CONTEXT clone)
+{
+  memcpy(&Context, clone, sizeof(Context));
+}
@@ -0,0 +1,89 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "vertex.h"
+
+/**
+ * The search context holds all the DYNAMIC state of the search, i.e.
+ * everything that is restored from the trail on backtracking.
+ *
+ * The MEMO data (cycles, cycle sets, faces, edges and vertices) is
+ * initialized once, and then shared read-only by every context.
+ * Every pointer in a context points into the MEMO data, so a context is
+ * cloned with a single memcpy, and the clone means the same thing in any
+ * thread.
+ *
+ * Each search thread has its own current Context; the trail and the engine
+ * stack, which hold addresses within it, stay with the thread.
+ */
+
+/* The DYNAMIC fields of a face, see struct face. */
+struct faceState {
+  /* cycle must be null if cycleSetSize is not 1. */
+  DYNAMIC struct facialCycle* cycle;
+
+  /* Links to previous and next faces with the same number of colors. */
+  DYNAMIC FACE previous;
+  DYNAMIC FACE next;
+
+  /* Number of possible cycles for this face */
+  DYNAMIC uint_trail cycleSetSize; /* holds up to NCYCLES */
+
+  /* Set of possible cycles for this face */
+  DYNAMIC CYCLESET_DECLARE possibleCycles;
+};
+
+/* Bitmaps of faces, indexed by the colors of the face. */
+#define FACESET_LENGTH ((NFACES - 1) / BITS_PER_WORD + 1)
+/* Bitmaps of cycleSetSize values, from 0 to NCYCLES. */
+#define SIZESET_LENGTH (NCYCLES / BITS_PER_WORD + 1)
+
+struct searchContext {
+  /* Indexed by the colors of the face. */
+  DYNAMIC struct faceState faces[NFACES];
+
+  /* The faces that have not been chosen, as buckets by cycleSetSize,
+   * and the sizes whose bucket is not empty, see searchChooseNextFace. */
+  DYNAMIC uint_trail facesBySize[NCYCLES + 1][FACESET_LENGTH];
+  DYNAMIC uint_trail sizesNonEmpty[SIZESET_LENGTH];
+
+  /* The to field of each edge, see struct edge. Indexed by the colors
+   * of the face and the color of the edge. */
+  DYNAMIC CURVELINK edgeTo[NFACES][NCOLORS];
+
+  /* For each vertex, the first of the two lines at the vertex.
+   * Lines count from 1; 0 means not yet set. */
+  DYNAMIC uint_trail vertexLineIds[NPOINTS];
+
+  /* Number of edges of each color, clockwise and counterclockwise. */
+  DYNAMIC uint64 edgeColorCounts[2][NCOLORS];
+
+  /* Number of times that one curve crosses from inside to outside another. */
+  DYNAMIC uint64 edgeCrossingCounts[NCOLORS][NCOLORS];
+
+  /* Non-zero for each curve that is a complete cycle. */
+  DYNAMIC uint64 edgeCurvesComplete[NCOLORS];
+
+  /* The corners chosen by the Corners predicate. */
+  DYNAMIC EDGE selectedCorners[NCOLORS][MAX_CORNERS];
+};
+
+typedef struct searchContext* SEARCH_CONTEXT;
+
+/* The current search context of this thread. */
+extern THREAD_LOCAL struct searchContext Context;
+
+/* Accessors for the DYNAMIC state of the MEMO faces, edges and vertices. */
+#define FACE_STATE(face) (&Context.faces[(face)->colors])
+#define EDGE_TO(edge) (Context.edgeTo[(edge)->colors][(edge)->color])
+#define VERTEX_LINE_ID(vertex) (Context.vertexLineIds[(vertex)->id])
+
+extern void initializeContext(void);
+extern void initializeContextSaveInitial(void);
+
+extern void contextClone(SEARCH_CONTEXT clone);
+extern void contextRestore(SEARCH_CONTEXT clone);
+
+#endif  // CONTEXT_H
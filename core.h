@@ -107,6 +107,13 @@
 #define DYNAMIC
 #endif
 
+/**
+ * THREAD_LOCAL marks global variables of which each search thread has its
+ * own copy. Unlike MEMO and DYNAMIC, this is not just a comment.
+ * See engineParallel in engine.h.
+ */
+#define THREAD_LOCAL _Thread_local
+
 /*--------------------------------------
  * Utility Macros
  *--------------------------------------*/
@@ -1,17 +1,17 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
 #include "common.h"
+#include "context.h"
 #include "face.h"
 #include "main.h"
 #include "predicates.h"
 #include "triangles.h"
+#include "visible_for_testing.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
-DYNAMIC EDGE SelectedCornersIPC[NCOLORS][3];
-
-static DYNAMIC EDGE PossibleCorners[NCOLORS][3][NFACES];
+static THREAD_LOCAL DYNAMIC EDGE PossibleCorners[NCOLORS][3][NFACES];
 
 /**
  * Count the number of edges in a null-terminated array
@@ -59,8 +59,8 @@ static struct predicateResult dynamicTryCorners(int round)
   }
 
   if (cornerIndex == 0 && colorIndex > 0) {
-    if (!dynamicTriangleLinesNotCrossed(colorIndex - 1,
-                                        SelectedCornersIPC + colorIndex - 1)) {
+    if (!dynamicTriangleLinesNotCrossed(
+            colorIndex - 1, Context.selectedCorners + colorIndex - 1)) {
       return PredicateFail;
     }
   }
@@ -82,10 +82,166 @@ static struct predicateResult dynamicRetryCorners(int round, int choice)
 {
   int cornerIndex = round % 3;
   int colorIndex = round / 3;
-  TRAIL_SET_POINTER(&SelectedCornersIPC[colorIndex][cornerIndex],
+  TRAIL_SET_POINTER(&Context.selectedCorners[colorIndex][cornerIndex],
                     PossibleCorners[colorIndex][cornerIndex][choice]);
   return PredicateSuccessSamePredicate;
 }
 
 struct predicate CornersPredicate = {"Corners", dynamicTryCorners,
-                                     dynamicRetryCorners};
+                                     dynamicRetryCorners, NULL};
+
+/*
+ * Counting the variations without enumerating them (-C).
+ *
+ * A variation chooses, independently for each color, one of the possible
+ * corners at each of its three corner positions. The only constraint
+ * between the colors is dynamicTriangleLinesNotCrossed: at a vertex of
+ * colors a < b, a's traversal records which of a's lines the vertex is on,
+ * and b's traversal fails if one of b's lines meets the same line of a
+ * twice. Every vertex is on exactly two colors, so the constraint is the
+ * conjunction of a constraint on each pair of colors. We tabulate, for each
+ * pair a < b, which choices of b are compatible with each choice of a, as
+ * bitsets, and count the compatible combinations, one color at a time.
+ */
+#define WORDS(n) (((n) + 63) / 64)
+
+static THREAD_LOCAL struct {
+  int length[3];
+  int count; /* The product of the three lengths */
+} Choices[NCOLORS];
+/* Choice i of color b is compatible with choice j of color a < b, when bit
+ * i of row j of Compatible[a][b] is set. */
+static THREAD_LOCAL uint64* Compatible[NCOLORS][NCOLORS];
+/* Whether every choice of the color is compatible with all later colors. */
+static THREAD_LOCAL bool Independent[NCOLORS];
+
+/* Sets the corners of choice i of the color. */
+static void selectChoice(COLOR color, int choice, EDGE (*corners)[3])
+{
+  for (int k = 0; k < 3; k++) {
+    (*corners)[k] = PossibleCorners[color][k][choice % Choices[color].length[k]];
+    choice /= Choices[color].length[k];
+  }
+}
+
+static void computeCompatible(COLOR a, COLOR b)
+{
+  TRAIL trail = trailBacktrackPoint();
+  int words = WORDS(Choices[b].count);
+  EDGE corners[3];
+  uint64* row = calloc((size_t)Choices[a].count * words, sizeof(uint64));
+  if (row == NULL) {
+    perror("calloc");
+    exit(EXIT_FAILURE);
+  }
+  Compatible[a][b] = row;
+  for (int j = 0; j < Choices[a].count; j++, row += words) {
+    TRAIL linesOfA;
+    selectChoice(a, j, &corners);
+    /* This sets the line of a at each of its vertices. */
+    (void)dynamicTriangleLinesNotCrossed(a, &corners);
+    linesOfA = trailBacktrackPoint();
+    for (int i = 0; i < Choices[b].count; i++) {
+      selectChoice(b, i, &corners);
+      if (dynamicTriangleLinesNotCrossed(b, &corners)) {
+        row[i / 64] |= 1ull << (i % 64);
+      } else {
+        Independent[a] = false;
+      }
+      trailRewindTo(linesOfA);
+    }
+    trailRewindTo(trail);
+  }
+}
+
+/* The number of compatible choices of colors from color on, given the
+ * choices of each color still allowed by the earlier colors. */
+static uint64 countCompatible(COLOR color, uint64* allowed[NCOLORS])
+{
+  uint64 result = 0;
+  uint64* narrowed[NCOLORS];
+  uint64 count = 0;
+  int words = WORDS(Choices[color].count);
+  if (color == NCOLORS) {
+    return 1;
+  }
+  if (Independent[color]) {
+    for (int w = 0; w < words; w++) {
+      count += __builtin_popcountll(allowed[color][w]);
+    }
+    return count == 0 ? 0 : count * countCompatible(color + 1, allowed);
+  }
+  for (COLOR b = color + 1; b < NCOLORS; b++) {
+    narrowed[b] = malloc(WORDS(Choices[b].count) * sizeof(uint64));
+    if (narrowed[b] == NULL) {
+      perror("malloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+  for (int j = 0; j < Choices[color].count; j++) {
+    bool possible = true;
+    if ((allowed[color][j / 64] & (1ull << (j % 64))) == 0) {
+      continue;
+    }
+    for (COLOR b = color + 1; b < NCOLORS && possible; b++) {
+      int bWords = WORDS(Choices[b].count);
+      uint64* row = Compatible[color][b] + (size_t)j * bWords;
+      uint64 any = 0;
+      for (int w = 0; w < bWords; w++) {
+        narrowed[b][w] = allowed[b][w] & row[w];
+        any |= narrowed[b][w];
+      }
+      possible = any != 0;
+    }
+    if (possible) {
+      result += countCompatible(color + 1, narrowed);
+    }
+  }
+  for (COLOR b = color + 1; b < NCOLORS; b++) {
+    free(narrowed[b]);
+  }
+  return result;
+}
+
+/**
+ * The number of variations of the current solution, i.e. the number of
+ * times that the Corners predicate would succeed without -n.
+ */
+uint64 cornersCountVariations(void)
+{
+  EDGE cornerPairs[3][2];
+  uint64* allowed[NCOLORS];
+  uint64 result;
+  for (COLOR color = 0; color < NCOLORS; color++) {
+    vertexAlignCorners(color, cornerPairs);
+    Choices[color].count = 1;
+    for (int k = 0; k < 3; k++) {
+      dynamicPossibleCorners(PossibleCorners[color][k], color,
+                             cornerPairs[k][0], cornerPairs[k][1]);
+      Choices[color].length[k] = edgeArrayLength(PossibleCorners[color][k]);
+      Choices[color].count *= Choices[color].length[k];
+    }
+    Independent[color] = true;
+    allowed[color] = calloc(WORDS(Choices[color].count), sizeof(uint64));
+    if (allowed[color] == NULL) {
+      perror("calloc");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < Choices[color].count; i++) {
+      allowed[color][i / 64] |= 1ull << (i % 64);
+    }
+  }
+  for (COLOR a = 0; a < NCOLORS; a++) {
+    for (COLOR b = a + 1; b < NCOLORS; b++) {
+      computeCompatible(a, b);
+    }
+  }
+  result = countCompatible(0, allowed);
+  for (COLOR a = 0; a < NCOLORS; a++) {
+    free(allowed[a]);
+    for (COLOR b = a + 1; b < NCOLORS; b++) {
+      free(Compatible[a][b]);
+    }
+  }
+  return result;
+}
@@ -9,6 +9,30 @@
 struct facialCycle Cycles[NCYCLES];
 static int NextCycle = 0;
 
+/*
+ * A sequence of colors, with the lowest first, is read as a number in base
+ * NCOLORS, with the first color as the least significant digit. Every other
+ * color is higher than the first, so no digit after the first is zero, and
+ * sequences of different lengths are different numbers, less than
+ * NCOLORS to the power NCOLORS.
+ */
+#define NSEQUENCES                                             \
+  (NCOLORS * NCOLORS * NCOLORS * (NCOLORS > 3 ? NCOLORS : 1) * \
+   (NCOLORS > 4 ? NCOLORS : 1) * (NCOLORS > 5 ? NCOLORS : 1) * \
+   (NCOLORS > 6 ? NCOLORS : 1))
+
+/* The cycle id of each sequence of colors, or NCYCLES if not a cycle. */
+static MEMO uint16_t CycleIdsBySequence[NSEQUENCES];
+
+static uint32_t sequenceNumber(COLOR* colors, uint32_t length)
+{
+  uint32_t result = 0;
+  while (length-- > 0) {
+    result = result * NCOLORS + colors[length];
+  }
+  return result;
+}
+
 static void addCycle(int length, COLOR* colors)
 {
   uint32_t color;
@@ -21,6 +45,7 @@ static void addCycle(int length, COLOR* colors)
     cycle->curves[ix] = color;
     cycle->colors |= 1u << color;
   }
+  CycleIdsBySequence[sequenceNumber(colors, length)] = cycle - Cycles;
 }
 static bool isCycleValid(int length, COLOR max, COLOR* cycle)
 {
@@ -156,21 +181,10 @@ char* cycleToString(CYCLE cycle)
 
 CYCLE_ID getCycleId(COLOR* cycle, uint32_t length)
 {
-  uint32_t cycleId;
-  uint32_t i;
-  for (cycleId = 0; cycleId < NCYCLES; cycleId++) {
-    if (Cycles[cycleId].length == length) {
-      for (i = 0; i < length; i++) {
-        if (Cycles[cycleId].curves[i] != cycle[i]) {
-          break;
-        }
-      }
-      if (i == length) {
-        return cycleId;
-      }
-    }
-  }
-  assert(NULL == "Unreachable");
+  CYCLE_ID cycleId = CycleIdsBySequence[sequenceNumber(cycle, length)];
+  assert(cycleId < NCYCLES);
+  assert(Cycles[cycleId].length == length);
+  return cycleId;
 }
 
 /* Reverses e.g. 1,2,3 to 1,3,2 i.e. the mirror image of the cycle. */
@@ -199,6 +213,9 @@ uint32_t cycleIndexOfColor(CYCLE cycle, COLOR color)
 void initializeCycles(void)
 {
   assert(NextCycle == 0);
+  for (uint32_t i = 0; i < NSEQUENCES; i++) {
+    CycleIdsBySequence[i] = NCYCLES;
+  }
   initializeAllCycles();
   assert(NextCycle == ARRAY_LEN(Cycles));
 }
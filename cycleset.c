@@ -2,6 +2,7 @@
 
 #include "cycleset.h"
 
+#include "cyclesetkernels.h"
 #include "trail.h"
 
 #include <string.h>
@@ -143,11 +144,7 @@ CYCLE cycleSetNext(CYCLESET cycleSet, CYCLE cycle)
 
 uint32_t cycleSetSize(CYCLESET cycleSet)
 {
-  uint32_t size = 0;
-  for (uint32_t i = 0; i < CYCLESET_LENGTH; i++) {
-    size += __builtin_popcountll(cycleSet[i]);
-  }
-  return size;
+  return CycleSetKernels->size(cycleSet);
 }
 
 void dynamicCycleSetRemoveCycle(CYCLESET cycleSet, uint32_t cycleId)
@@ -220,5 +217,6 @@ void initializeCycleSets(void)
     initializeSameDirection();
     initializeOppositeDirection();
     initializeOmittingCycleSets();
+    initializeCycleSetKernels();
   }
 }
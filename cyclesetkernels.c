@@ -0,0 +1,122 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "cyclesetkernels.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define X86_KERNELS 1
+#else
+#define X86_KERNELS 0
+#endif
+
+/*
+ * The word by word loops are shared by all the kernels. They are always
+ * inlined, so that each copy is compiled for the instruction set of its
+ * caller: __builtin_popcountll is then the POPCNT instruction in the POPCNT
+ * kernels.
+ */
+#define KERNEL_LOOP static inline __attribute__((always_inline))
+
+KERNEL_LOOP uint32_t wordsSize(const uint64 *cycleSet, uint32_t from,
+                               uint32_t to)
+{
+  uint32_t size = 0;
+  for (uint32_t i = from; i < to; i++) {
+    size += __builtin_popcountll(cycleSet[i]);
+  }
+  return size;
+}
+
+KERNEL_LOOP uint32_t wordsRestrictTo(uint_trail *cycleSet, uint64 *stamps,
+                                     const uint64 *onlyCycleSet,
+                                     uint32_t from, uint32_t to)
+{
+  uint32_t removed = 0;
+  for (uint32_t i = from; i < to; i++) {
+    uint64 toBeCleared = cycleSet[i] & ~onlyCycleSet[i];
+    if (toBeCleared != 0) {
+      trailSetIntOnce(&cycleSet[i], cycleSet[i] & onlyCycleSet[i],
+                      &stamps[i]);
+      removed += __builtin_popcountll(toBeCleared);
+    }
+  }
+  return removed;
+}
+
+static uint32_t scalarSize(const uint64 *cycleSet)
+{
+  return wordsSize(cycleSet, 0, CYCLESET_LENGTH);
+}
+
+static uint32_t scalarRestrictTo(uint_trail *cycleSet, uint64 *stamps,
+                                 const uint64 *onlyCycleSet)
+{
+  return wordsRestrictTo(cycleSet, stamps, onlyCycleSet, 0, CYCLESET_LENGTH);
+}
+
+static const struct cycleSetKernels ScalarKernels = {
+    "scalar",
+    scalarSize,
+    scalarRestrictTo,
+};
+
+#if X86_KERNELS
+/*
+ * The same loops, compiled with POPCNT. Vector versions of restrictTo,
+ * with SSE4.1 PTEST or AVX2 checking two or four words for a change at
+ * once, were no faster than these: the sets are short, and most calls
+ * change a word, so the test only adds to the loop.
+ */
+#define POPCNT __attribute__((target("popcnt")))
+
+POPCNT static uint32_t popcntSize(const uint64 *cycleSet)
+{
+  return wordsSize(cycleSet, 0, CYCLESET_LENGTH);
+}
+
+POPCNT static uint32_t popcntRestrictTo(uint_trail *cycleSet, uint64 *stamps,
+                                        const uint64 *onlyCycleSet)
+{
+  return wordsRestrictTo(cycleSet, stamps, onlyCycleSet, 0, CYCLESET_LENGTH);
+}
+
+static const struct cycleSetKernels PopcntKernels = {
+    "popcnt",
+    popcntSize,
+    popcntRestrictTo,
+};
+#endif
+
+const struct cycleSetKernels *CycleSetKernels = &ScalarKernels;
+
+static const struct cycleSetKernels *kernelsByName(const char *name)
+{
+  if (strcmp(name, ScalarKernels.name) == 0) {
+    return &ScalarKernels;
+  }
+#if X86_KERNELS
+  __builtin_cpu_init();
+  if (strcmp(name, PopcntKernels.name) == 0) {
+    return __builtin_cpu_supports("popcnt") ? &PopcntKernels : NULL;
+  }
+#endif
+  return NULL;
+}
+
+bool cycleSetUseKernels(const char *name)
+{
+  const struct cycleSetKernels *kernels = kernelsByName(name);
+  if (kernels == NULL) {
+    return false;
+  }
+  CycleSetKernels = kernels;
+  return true;
+}
+
+void initializeCycleSetKernels(void)
+{
+  if (!cycleSetUseKernels("popcnt")) {
+    cycleSetUseKernels("scalar");
+  }
+}
@@ -0,0 +1,38 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef CYCLESETKERNELS_H
+#define CYCLESETKERNELS_H
+
+#include "trail.h"
+
+/**
+ * The cycle set operations in the inner loop of the search, i.e. those of
+ * cycleSetSize and dynamicRestrictCycles, compiled with POPCNT if the CPU
+ * supports it, as checked at runtime by initializeCycleSetKernels, or else
+ * as portable C. The build does not use -march, so only these functions
+ * use POPCNT, without which __builtin_popcountll is a library call.
+ *
+ * Each cycle set is CYCLESET_LENGTH words.
+ */
+struct cycleSetKernels {
+  const char *name;
+  /* The number of cycles in the set. */
+  uint32_t (*size)(const uint64 *cycleSet);
+  /* Removes the cycles not in onlyCycleSet from cycleSet, on the trail,
+   * writing just the words that change, with trailSetIntOnce and the
+   * stamps of each word. Returns the number removed. */
+  uint32_t (*restrictTo)(uint_trail *cycleSet, uint64 *stamps,
+                         const uint64 *onlyCycleSet);
+};
+
+/* The kernels in use, which are the portable ones until initialized. */
+extern const struct cycleSetKernels *CycleSetKernels;
+
+/* Chooses the best kernels that the CPU supports. */
+extern void initializeCycleSetKernels(void);
+
+/* Uses the named kernels, for tests and benchmarks; false if the CPU does
+ * not support them. The names are "popcnt" and "scalar". */
+extern bool cycleSetUseKernels(const char *name);
+
+#endif  // CYCLESETKERNELS_H
@@ -1,5 +1,6 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#include "cyclesetkernels.h"
 #include "face.h"
 #include "failure.h"
 #include "s6.h"
@@ -7,8 +8,8 @@
 #include "utils.h"
 #include "visible_for_testing.h"
 
-uint64 CycleForcedCounter = 0;
-uint64 CycleSetReducedCounter = 0;
+THREAD_LOCAL uint64 CycleForcedCounter = 0;
+THREAD_LOCAL uint64 CycleSetReducedCounter = 0;
 
 static void setupColors(VERTEX vertex, COLOR colors[2])
 {
@@ -19,52 +20,135 @@ static void setupColors(VERTEX vertex, COLOR colors[2])
 static void validateIncomingEdges(VERTEX vertex)
 {
   for (int incomingEdgeSlot = 0; incomingEdgeSlot < 4; incomingEdgeSlot++) {
-    assert(vertex->incomingEdges[incomingEdgeSlot]->to != NULL);
+    assert(EDGE_TO(vertex->incomingEdges[incomingEdgeSlot]) != NULL);
   }
 }
 
-void dynamicRecomputeCountOfChoices(FACE face)
+/*
+ * The faces that have not been chosen are queued in Context.facesBySize,
+ * in the bucket for their cycleSetSize. A face is dequeued as its cycle is
+ * chosen or forced, and the trail puts it back on backtracking.
+ */
+#define FACE_WORD(face) ((face)->colors / BITS_PER_WORD)
+#define FACE_BIT(face) (1ull << ((face)->colors % BITS_PER_WORD))
+#define SIZE_WORD(size) ((size) / BITS_PER_WORD)
+#define SIZE_BIT(size) (1ull << ((size) % BITS_PER_WORD))
+
+/*
+ * The stamps of trailSetIntOnce for the queue, and for the possible cycles
+ * of each face, and their number: a face may be restricted, and move
+ * between buckets, many times in one propagation.
+ */
+static THREAD_LOCAL struct {
+  uint64 facesBySize[NCYCLES + 1][FACESET_LENGTH];
+  uint64 sizesNonEmpty[SIZESET_LENGTH];
+  struct {
+    uint64 possibleCycles[CYCLESET_LENGTH];
+    uint64 cycleSetSize;
+  } faces[NFACES];
+} Stamps;
+
+static void dynamicQueueAdd(FACE face, uint64 size)
 {
-  trailSetInt(&face->cycleSetSize, cycleSetSize(face->possibleCycles));
+  uint_trail* bucket = Context.facesBySize[size];
+  uint_trail* sizes = &Context.sizesNonEmpty[SIZE_WORD(size)];
+  if ((*sizes & SIZE_BIT(size)) == 0) {
+    trailSetIntOnce(sizes, *sizes | SIZE_BIT(size),
+                    &Stamps.sizesNonEmpty[SIZE_WORD(size)]);
+  }
+  trailSetIntOnce(&bucket[FACE_WORD(face)],
+                  bucket[FACE_WORD(face)] | FACE_BIT(face),
+                  &Stamps.facesBySize[size][FACE_WORD(face)]);
 }
 
-static void dynamicRestrictCycles(FACE face, CYCLESET cycleSet)
+static void dynamicQueueRemove(FACE face, uint64 size)
 {
+  uint_trail* bucket = Context.facesBySize[size];
+  uint_trail* sizes = &Context.sizesNonEmpty[SIZE_WORD(size)];
   uint32_t i;
-  uint_trail toBeCleared;
-  uint_trail newCycleSetSize = face->cycleSetSize;
+  trailSetIntOnce(&bucket[FACE_WORD(face)],
+                  bucket[FACE_WORD(face)] & ~FACE_BIT(face),
+                  &Stamps.facesBySize[size][FACE_WORD(face)]);
+  for (i = 0; i < FACESET_LENGTH && bucket[i] == 0; i++) {
+  }
+  if (i == FACESET_LENGTH) {
+    trailSetIntOnce(sizes, *sizes & ~SIZE_BIT(size),
+                    &Stamps.sizesNonEmpty[SIZE_WORD(size)]);
+  }
+}
 
-  for (i = 0; i < CYCLESET_LENGTH; i++) {
-    toBeCleared = face->possibleCycles[i] & ~cycleSet[i];
-    if (toBeCleared == 0) {
-      continue;
+static bool dynamicFaceIsQueued(FACE face)
+{
+  uint_trail* bucket = Context.facesBySize[FACE_STATE(face)->cycleSetSize];
+  return (bucket[FACE_WORD(face)] & FACE_BIT(face)) != 0;
+}
+
+void dynamicFaceDequeue(FACE face)
+{
+  if (dynamicFaceIsQueued(face)) {
+    dynamicQueueRemove(face, FACE_STATE(face)->cycleSetSize);
+  }
+}
+
+void initializeFaceQueue(void)
+{
+  for (uint32_t i = 0; i < NFACES; i++) {
+    if (Context.faces[i].cycle == NULL) {
+      dynamicQueueAdd(Faces + i, Context.faces[i].cycleSetSize);
     }
-    trailSetInt(&face->possibleCycles[i],
-                face->possibleCycles[i] & cycleSet[i]);
-    newCycleSetSize -= __builtin_popcountll(toBeCleared);
   }
-  if (newCycleSetSize < face->cycleSetSize) {
+}
+
+void dynamicRecomputeCountOfChoices(FACE face)
+{
+  struct faceState* state = FACE_STATE(face);
+  uint_trail size = cycleSetSize(state->possibleCycles);
+  if (dynamicFaceIsQueued(face)) {
+    dynamicQueueRemove(face, state->cycleSetSize);
+    dynamicQueueAdd(face, size);
+  }
+  trailSetInt(&state->cycleSetSize, size);
+}
+
+static void dynamicRestrictCycles(FACE face, CYCLESET cycleSet)
+{
+  struct faceState* state = FACE_STATE(face);
+  uint_trail newCycleSetSize =
+      state->cycleSetSize -
+      CycleSetKernels->restrictTo(state->possibleCycles,
+                                  Stamps.faces[face->colors].possibleCycles,
+                                  cycleSet);
+
+  if (newCycleSetSize < state->cycleSetSize) {
     CycleSetReducedCounter++;
-    trailSetInt(&face->cycleSetSize, newCycleSetSize);
+    /* The face is queued, since it has no cycle. With one cycle left, it
+     * is about to be forced, so it is not requeued. */
+    dynamicQueueRemove(face, state->cycleSetSize);
+    if (newCycleSetSize != 1) {
+      dynamicQueueAdd(face, newCycleSetSize);
+    }
+    trailSetIntOnce(&state->cycleSetSize, newCycleSetSize,
+                    &Stamps.faces[face->colors].cycleSetSize);
   }
 }
 
 static void dynamicCountEdge(EDGE edge)
 {
   uint_trail* edgeCountPtr =
-      &EdgeColorCountState[IS_CLOCKWISE_EDGE(edge)][edge->color];
+      &Context.edgeColorCounts[IS_CLOCKWISE_EDGE(edge)][edge->color];
   trailSetInt(edgeCountPtr, (*edgeCountPtr) + 1);
 }
 
 static FAILURE dynamicHandleExistingEdge(FACE face, COLOR aColor, COLOR bColor,
                                          int depth)
 {
-  if (face->edges[aColor].to != NULL) {
-    assert(face->edges[aColor].to != &face->edges[aColor].possiblyTo[aColor]);
-    if (face->edges[aColor].to != &face->edges[aColor].possiblyTo[bColor]) {
+  EDGE edge = &face->edges[aColor];
+  if (EDGE_TO(edge) != NULL) {
+    assert(EDGE_TO(edge) != &edge->possiblyTo[aColor]);
+    if (EDGE_TO(edge) != &edge->possiblyTo[bColor]) {
       return failureVertexConflict(depth);
     }
-    assert(face->edges[aColor].to == &face->edges[aColor].possiblyTo[bColor]);
+    assert(EDGE_TO(edge) == &edge->possiblyTo[bColor]);
     return NULL;
   }
   return NULL;
@@ -97,18 +181,19 @@ static FAILURE dynamicProcessIncomingEdge(EDGE edge, COLOR colors[2],
   assert(edge->color == colors[colorIndex]);
   assert(edge->color != colors[otherColorIndex]);
 
-  if (edge->to != NULL) {
+  if (EDGE_TO(edge) != NULL) {
     // If the edge already has a destination, ensure it's consistent
-    if (edge->to != &edge->possiblyTo[colors[colorIndex]]) {
+    if (EDGE_TO(edge) != &edge->possiblyTo[colors[colorIndex]]) {
       return failureVertexConflict(depth);
     }
-    assert(edge->to == &edge->possiblyTo[colors[otherColorIndex]]);
+    assert(EDGE_TO(edge) == &edge->possiblyTo[colors[otherColorIndex]]);
   } else {
     // Set the edge's destination to connect to the other color
-    TRAIL_SET_POINTER(&edge->to, &edge->possiblyTo[colors[otherColorIndex]]);
+    TRAIL_SET_POINTER(&EDGE_TO(edge),
+                      &edge->possiblyTo[colors[otherColorIndex]]);
   }
 
-  assert(edge->to != &edge->possiblyTo[edge->color]);
+  assert(EDGE_TO(edge) != &edge->possiblyTo[edge->color]);
   return NULL;
 }
 
@@ -119,7 +204,7 @@ static FAILURE dynamicCheckLengthOfCycleOfFaces(FACE face)
   FACE f = face;
   assert(expected != 1);  // Don't call with inner or outer face
   do {
-    f = f->next;
+    f = FACE_STATE(f)->next;
     i++;
     assert(i <= expected);
     if (f == face) {
@@ -142,18 +227,19 @@ bool dynamicFaceSetCycleLength(uint32_t faceColors, FACE_DEGREE length)
   }
   for (cycleId = 0, cycle = Cycles; cycleId < NCYCLES; cycleId++, cycle++) {
     if (cycle->length != length) {
-      dynamicCycleSetRemoveCycle(face->possibleCycles, cycleId);
+      dynamicCycleSetRemoveCycle(FACE_STATE(face)->possibleCycles, cycleId);
     }
   }
   dynamicRecomputeCountOfChoices(face);
-  return face->cycleSetSize != 0;
+  return FACE_STATE(face)->cycleSetSize != 0;
 }
 
 FAILURE dynamicFaceRestrictAndPropagateCycles(FACE face, CYCLESET onlyCycleSet,
                                               int depth)
 {
-  if (face->cycleSetSize == 1 || face->cycle != NULL) {
-    if (!cycleSetMember(face->cycle - Cycles, onlyCycleSet)) {
+  struct faceState* state = FACE_STATE(face);
+  if (state->cycleSetSize == 1 || state->cycle != NULL) {
+    if (!cycleSetMember(state->cycle - Cycles, onlyCycleSet)) {
       return failureConflictingConstraints(depth);
     }
     return NULL;
@@ -161,13 +247,13 @@ FAILURE dynamicFaceRestrictAndPropagateCycles(FACE face, CYCLESET onlyCycleSet,
 
   dynamicRestrictCycles(face, onlyCycleSet);
 
-  if (face->cycleSetSize == 0) {
+  if (state->cycleSetSize == 0) {
     return failureNoMatchingCycles(depth);
   }
-  if (face->cycleSetSize == 1) {
-    TRAIL_SET_POINTER(&face->cycle, cycleSetFirst(face->possibleCycles));
+  if (state->cycleSetSize == 1) {
+    TRAIL_SET_POINTER(&state->cycle, cycleSetFirst(state->possibleCycles));
     CycleForcedCounter++;
-    return dynamicFaceChoice(face, depth + 1);
+    dynamicFaceChoice(face, depth + 1);
   }
   return NULL;
 }
@@ -180,7 +266,7 @@ void dynamicFaceSetupCentral(FACE_DEGREE* faceDegrees)
     dynamicFaceSetCycleLength(~(1 << i), faceDegrees[i]);
   }
   // The cycle (a b c d e f) is the last one.
-  centralFace->cycle = &Cycles[NCYCLES - 1];
+  FACE_STATE(centralFace)->cycle = &Cycles[NCYCLES - 1];
   dynamicFaceBacktrackableChoice(centralFace);
 }
 
@@ -193,7 +279,7 @@ FAILURE dynamicFaceIncludeVertex(FACE face, COLOR aColor, COLOR bColor,
   COLOR colors[2];
 
   failure = dynamicHandleExistingEdge(face, aColor, bColor, depth);
-  if (failure != NULL || face->edges[aColor].to != NULL) {
+  if (failure != NULL || EDGE_TO(&face->edges[aColor]) != NULL) {
     return failure;
   }
 
@@ -217,11 +303,12 @@ bool dynamicColorRemoveFromSearch(COLOR color)
   FACE f;
   uint32_t i;
   for (i = 0, f = Faces; i < NFACES; i++, f++) {
-    if (f->cycle == NULL) {
+    if (FACE_STATE(f)->cycle == NULL) {
       /* Discard failure, we will report a different one. */
-      if (f->edges[color].to == NULL &&
-          dynamicFaceRestrictAndPropagateCycles(
-              f, CycleSetOmittingOneColor[color], 0) != NULL) {
+      if (EDGE_TO(&f->edges[color]) == NULL &&
+          (dynamicFaceRestrictAndPropagateCycles(
+               f, CycleSetOmittingOneColor[color], 0) != NULL ||
+           dynamicFacePropagate() != NULL)) {
         return false;
       }
     }
@@ -245,7 +332,8 @@ FAILURE dynamicFaceFinalCorrectnessChecks(void)
       break;
   }
 #endif
-  for (colors = 1; colors < (NFACES - 1); colors |= face->previous->colors) {
+  for (colors = 1; colors < (NFACES - 1);
+       colors |= FACE_STATE(face)->previous->colors) {
     face = Faces + colors;
     CHECK_FAILURE(dynamicCheckLengthOfCycleOfFaces(face));
   }
@@ -255,19 +343,19 @@ FAILURE dynamicFaceFinalCorrectnessChecks(void)
 FAILURE dynamicFacePropagateChoice(FACE face, EDGE edge, int depth)
 {
   FAILURE failure;
-  VERTEX vertex = edge->to->vertex;
+  VERTEX vertex = EDGE_TO(edge)->vertex;
   COLOR aColor = edge->color;
   COLOR bColor =
       edge->color == vertex->primary ? vertex->secondary : vertex->primary;
 
   FACE aFace = face->adjacentFaces[edge->color];
   FACE abFace = aFace->adjacentFaces[bColor];
-  uint32_t index = cycleIndexOfColor(face->cycle, aColor);
+  uint32_t index = cycleIndexOfColor(FACE_STATE(face)->cycle, aColor);
   assert(abFace == face->adjacentFaces[bColor]->adjacentFaces[aColor]);
   assert(abFace != face);
   CHECK_FAILURE(dynamicFaceRestrictAndPropagateCycles(
-      abFace, face->cycle->sameDirection[index], depth));
+      abFace, FACE_STATE(face)->cycle->sameDirection[index], depth));
   CHECK_FAILURE(dynamicFaceRestrictAndPropagateCycles(
-      aFace, face->cycle->oppositeDirection[index], depth));
+      aFace, FACE_STATE(face)->cycle->oppositeDirection[index], depth));
   return NULL;
 }
@@ -3,9 +3,9 @@
 #ifndef DYNAMICFACE_H
 #define DYNAMICFACE_H
 
+#include "context.h"
 #include "failure.h"
 #include "trail.h"
-#include "vertex.h"
 
 /**
  * Dynamic face system for backtracking-aware face operations.
@@ -23,6 +23,12 @@ typedef struct face* FACE;
  */
 extern void dynamicFaceSetupCentral(FACE_DEGREE* faceDegrees);
 
+/**
+ * Puts every face without a cycle in the queue of faces to choose, after
+ * the initial cycleSetSize of each face has been computed.
+ */
+extern void initializeFaceQueue(void);
+
 /**
  * Sets the exact cycle length for a face with given colors.
  * @param faceColors Bit set representing face colors
@@ -51,8 +57,9 @@ extern FAILURE dynamicFaceIncludeVertex(FACE face, COLOR aColor, COLOR bColor,
 extern bool dynamicColorRemoveFromSearch(COLOR color);
 
 /**
- * Propagates cycle constraints from a face through the diagram.
- * @param face Starting face for propagation
+ * Restricts the possible cycles of a face. If just one is left, the face is
+ * queued, and its consequences are propagated by dynamicFacePropagate.
+ * @param face Face to restrict
  * @param onlyCycleSet Restricted set of cycles to consider
  * @param depth Current search depth
  * @return Failure object if propagation fails, NULL otherwise
@@ -77,6 +84,13 @@ extern FAILURE dynamicFacePropagateChoice(FACE face, EDGE edge, int depth);
  */
 extern void dynamicRecomputeCountOfChoices(FACE face);
 
+/**
+ * Removes a face from the queue of faces to choose, as its cycle is chosen,
+ * if it is queued.
+ * @param face Face whose cycle is chosen
+ */
+extern void dynamicFaceDequeue(FACE face);
+
 /**
  * Performs final correctness checks on the diagram.
  * @return Failure object if check fails, NULL otherwise
@@ -87,11 +101,11 @@ extern FAILURE dynamicFaceFinalCorrectnessChecks(void);
 /**
  * Counter for tracking how many cycles were forced during search.
  */
-extern uint64 CycleForcedCounter;
+extern THREAD_LOCAL uint64 CycleForcedCounter;
 
 /**
  * Counter for tracking how many cycle sets were reduced during search.
  */
-extern uint64 CycleSetReducedCounter;
+extern THREAD_LOCAL uint64 CycleSetReducedCounter;
 
 #endif /* DYNAMICFACE_H */
@@ -2,23 +2,21 @@
 
 #include "edge.h"
 
+#include "context.h"
 #include "trail.h"
 
-uint64 EdgeColorCountState[2][NCOLORS];
-COLORSET ColorCompletedState;
+THREAD_LOCAL COLORSET ColorCompletedState;
 
 /* If we have convex polygons A and B both with N sides, then they can cross
    each other in at most 2*N different points. For half A crosses outside B. */
 #define MAX_ONE_WAY_CURVE_CROSSINGS MAX_CORNERS
-static uint64 EdgeCrossingCounts[NCOLORS][NCOLORS];
-static uint64 EdgeCurvesComplete[NCOLORS];
 
 static EDGE edgeFollowForwards(EDGE edge)
 {
-  if (edge->to == NULL) {
+  if (EDGE_TO(edge) == NULL) {
     return NULL;
   }
-  return edge->to->next;
+  return EDGE_TO(edge)->next;
 }
 
 static uint_trail curveLength(EDGE edge)
@@ -35,18 +33,20 @@ static uint_trail curveLength(EDGE edge)
 static FAILURE dynamicCheckForDisconnectedCurve(EDGE edge, int depth)
 {
   uint_trail length;
-  if (edge->reversed->to != NULL) {
+  if (EDGE_TO(edge->reversed) != NULL) {
     // We have a colored cycle in the FISC.
+    uint64 count =
+        Context.edgeColorCounts[IS_CLOCKWISE_EDGE(edge)][edge->color];
     length = curveLength(edge);
-    if (length < EdgeColorCountState[IS_CLOCKWISE_EDGE(edge)][edge->color]) {
+    if (length < count) {
       return failureDisconnectedCurve(depth);
     }
-    assert(length == EdgeColorCountState[IS_CLOCKWISE_EDGE(edge)][edge->color]);
+    assert(length == count);
     if (ColorCompletedState & 1u << edge->color) {
       return NULL;
     }
     ColorCompletedState |= 1u << edge->color;
-    trailSetInt(&EdgeCurvesComplete[edge->color], 1);
+    trailSetInt(&Context.edgeCurvesComplete[edge->color], 1);
   }
   return NULL;
 }
@@ -65,7 +65,7 @@ static EDGE findStartOfCurve(EDGE edge)
 
 FAILURE dynamicEdgeCheckCrossingLimit(COLOR a, COLOR b, int depth)
 {
-  uint_trail* crossing = &EdgeCrossingCounts[a][b];
+  uint_trail* crossing = &Context.edgeCrossingCounts[a][b];
   if (*crossing + 1 > MAX_ONE_WAY_CURVE_CROSSINGS) {
     return failureCrossingLimit(depth);
   }
@@ -75,7 +75,7 @@ FAILURE dynamicEdgeCheckCrossingLimit(COLOR a, COLOR b, int depth)
 
 FAILURE dynamicEdgeCurveChecks(EDGE edge, int depth)
 {
-  if (EdgeCurvesComplete[edge->color]) {
+  if (Context.edgeCurvesComplete[edge->color]) {
     return NULL;
   }
   EDGE start = findStartOfCurve(edge);
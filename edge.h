@@ -50,11 +50,11 @@ struct edge {
   MEMO EDGE reversed;
 
   /*
-   * to starts off as NULL, and is set to the jth member of possiblyTo
+   * The DYNAMIC to field is in the search context: see EDGE_TO in context.h.
+   * It starts off as NULL, and is set to the jth member of possiblyTo
    * where (color, j) is in the facial cycle of inner, equivalently
    * (j, color) is in the facial cycle of outer.
    */
-  DYNAMIC CURVELINK to;
 
   /* This vertex at the end of this edge may cross one of the other colors.
    * We have all 5 pre-initialized in this array, with the color-th entry
@@ -67,17 +67,10 @@ struct edge {
  * Global Variables
  *--------------------------------------*/
 
-/**
- * Tracks the count of edges for each color in the diagram.
- * First dimension: 0=edges with no vertex, 1=edges with vertex
- * Second dimension: color index
- */
-extern uint64 EdgeColorCountState[2][NCOLORS];
-
 /**
  * Bit set tracking which colors have all their edges completed.
  */
-extern COLORSET ColorCompletedState;
+extern THREAD_LOCAL COLORSET ColorCompletedState;
 
 /*--------------------------------------
  * Edge Navigation Functions
@@ -1,5 +1,6 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#define _GNU_SOURCE
 #include "engine.h"
 
 #include "face.h"
@@ -8,27 +9,113 @@
 #include "trail.h"
 #include "visible_for_testing.h"
 
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#endif
+
 /**
  * The engine implements a WAM-like execution model for search.
  * See docs/DESIGN.md "Non-deterministic Engine, Backtracking, Memory and the
  * Trail" for detailed documentation.
  */
 
-/* We use 16384 which is about twice what we need. */
-#define TRAIL_SIZE 16384
-#define MAX_STACK_SIZE 1000
+/*
+ * The trail of each thread is one range of address space, reserved by
+ * initializeThreadEngine, and made usable a segment at a time, as the trail
+ * reaches TrailLimit. Six curves need less than 8500 entries, which is well
+ * inside the first segment. Since the trail never moves, a TRAIL is a
+ * pointer that can be compared, and rewinding is a simple loop.
+ */
+#define TRAIL_SEGMENT_SIZE (1 << 16)
+#define TRAIL_MAX_SEGMENTS 1024
 
 struct trail {
   void* ptr;
   uint_trail value;
 };
 
-static struct trail TrailArray[TRAIL_SIZE];
-TRAIL Trail = TrailArray;
-static TRAIL frozenTrail = NULL;
-static uint64 MaxTrailSize = 0;
-static struct stackEntry stack[MAX_STACK_SIZE + 1], *stackTop = stack;
-static int Counter = 0;
+static THREAD_LOCAL TRAIL TrailArray = NULL;
+static THREAD_LOCAL TRAIL TrailLimit = NULL;
+/* Trail and stackTop are set by initializeThreadEngine. */
+THREAD_LOCAL TRAIL Trail = NULL;
+static THREAD_LOCAL TRAIL frozenTrail = NULL;
+static THREAD_LOCAL uint64 MaxTrailSize = 0;
+/*
+ * The generation of the trail, which changes whenever the trail might be
+ * rewound to its current end, and whenever it is rewound. A stamp of
+ * trailSetIntOnce that equals it shows that the old value has already been
+ * trailed since the last backtrack point. Stamps start at 0.
+ */
+static THREAD_LOCAL uint64 TrailGeneration = 1;
+
+/*
+ * The counters of each predicate, in the order first seen. The largest
+ * trail while it is running is reported as "MaxTrail <name>". The calls,
+ * retries and fails through its ports, and the cycles spent in its try and
+ * retry functions, are reported as "Calls <name>" etc., in the full report
+ * only; they show how the time divides between the search, the corners and
+ * the output. Any predicates after the first MAX_PREDICATES, which only
+ * happens in the tests, are not tracked.
+ */
+#define MAX_PREDICATES 16
+static THREAD_LOCAL struct predicateStatistics {
+  PREDICATE predicate;
+  uint64 maxTrailSize;
+  uint64 calls;
+  uint64 retries;
+  uint64 fails;
+  uint64 cycles;
+} PredicateStatistics[MAX_PREDICATES];
+static THREAD_LOCAL struct stackEntry stack[MAX_STACK_SIZE + 1],
+    *stackTop = NULL;
+static THREAD_LOCAL int Counter = 0;
+
+/*
+ * Work sharing for engineParallel: each search thread runs the whole
+ * program, and the calls of SplitPredicate in round SplitRound are the
+ * tasks, numbered in the (identical) order each thread reaches them; so
+ * are the calls of the next predicate, when SplitPredicate finishes in an
+ * earlier round. A thread claims a task from the shared NextTask counter,
+ * and fails every task it has not claimed. Active has the task claimed by
+ * each thread, until it is finished, or INT_MAX; it is protected by
+ * TasksMutex, and TaskFinished is signalled as each task is finished.
+ */
+static PREDICATE SplitPredicate = NULL;
+static int SplitRound = 0;
+static pthread_mutex_t TasksMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t TaskFinished = PTHREAD_COND_INITIALIZER;
+static int NextTask;
+static int* Active = NULL;
+static int NumberOfSearchThreads = 0;
+static atomic_int NextSearchThread;
+static THREAD_LOCAL int SearchThread = -1;
+static THREAD_LOCAL int TasksSeen = 0;
+static THREAD_LOCAL int TaskClaimed = -1;
+/* The depth of the call of the claimed task, while it is searched, or -1. */
+static THREAD_LOCAL int TaskDepth = -1;
+static THREAD_LOCAL bool WaitedForEarlierTasks = false;
+
+/* The path being followed, see engineReplay; NULL when searching. */
+static THREAD_LOCAL struct choicePoint* ReplayPath = NULL;
+static THREAD_LOCAL int ReplayLength = 0;
+static THREAD_LOCAL void (*Replayed)(void) = NULL;
+/*
+ * The depth of the call whose subtree is searched, see engineSubtree, or
+ * -1 for the whole tree. Once that call has failed, the engine is outside
+ * the subtree, and the choices that are left are skipped, see skipChoices.
+ */
+static THREAD_LOCAL int SubtreeDepth = -1;
+static THREAD_LOCAL bool OutsideSubtree = false;
+/* The depth at which calls are cut off, see engineStopAt, or -1. */
+static THREAD_LOCAL int StopDepth = -1;
+static THREAD_LOCAL void (*Reached)(void) = NULL;
 
 const struct predicateResult PredicateFail = {PREDICATE_FAIL, 0};
 const struct predicateResult PredicateSuccessNextPredicate = {
@@ -60,6 +147,92 @@ static void trace(const char* message)
   }
 }
 
+/* The time stamp counter, or nanoseconds where there is none. */
+static inline uint64 cycleCount(void)
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+  return __rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+/* Returns "<prefix> <name>", or "<prefix><name>" if prefix is one letter. */
+static char* statisticName(const char* prefix, PREDICATE predicate)
+{
+  char* result = malloc(strlen(prefix) + strlen(predicate->name) + 2);
+  if (result == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  sprintf(result, prefix[1] == '\0' ? "%s%s" : "%s %s", prefix,
+          predicate->name);
+  return result;
+}
+
+static struct predicateStatistics* predicateStatistics(PREDICATE predicate)
+{
+  struct predicateStatistics* statistics;
+  for (int i = 0; i < MAX_PREDICATES; i++) {
+    statistics = &PredicateStatistics[i];
+    if (statistics->predicate == predicate) {
+      return statistics;
+    }
+    if (statistics->predicate == NULL) {
+      statistics->predicate = predicate;
+      statisticIncludeDetail(&statistics->calls, statisticName("c", predicate),
+                             statisticName("Calls", predicate));
+      statisticIncludeDetail(&statistics->retries,
+                             statisticName("r", predicate),
+                             statisticName("Retries", predicate));
+      statisticIncludeDetail(&statistics->fails, statisticName("f", predicate),
+                             statisticName("Fails", predicate));
+      statisticIncludeDetail(&statistics->cycles,
+                             statisticName("t", predicate),
+                             statisticName("Cycles", predicate));
+      return statistics;
+    }
+  }
+  return NULL;
+}
+
+/* The statistic is only included when first set, so that it follows those
+ * included by the Initialize predicate. */
+static void noteNewMaxTrailSize(uint64* maxTrailSize, uint64 trailSize)
+{
+  if (*maxTrailSize == 0) {
+    statisticIncludeMaximum(maxTrailSize,
+                            statisticName("$", stackTop->predicate),
+                            statisticName("MaxTrail", stackTop->predicate),
+                            true);
+  }
+  *maxTrailSize = trailSize;
+}
+
+/* Called after each call of a predicate through port, one of the counters
+ * of its statistics, with the cycle count before the call. */
+static void notePort(uint64* port, uint64 start)
+{
+  struct predicateStatistics* statistics = stackTop->statistics;
+  uint64 trailSize = Trail - TrailArray;
+  statistics->cycles += cycleCount() - start;
+  (*port)++;
+  if (trailSize > statistics->maxTrailSize) {
+    noteNewMaxTrailSize(&statistics->maxTrailSize, trailSize);
+  }
+}
+
+static void checkStackSize(void)
+{
+  if (stackTop == stack + MAX_STACK_SIZE) {
+    fprintf(stderr, "More than %d nested rounds of the predicates\n",
+            MAX_STACK_SIZE);
+    exit(EXIT_FAILURE);
+  }
+}
+
 /**
  * Initializes a new stack entry after success. .
  * Maybe for the same, or for the next predicate.
@@ -74,24 +247,153 @@ static void pushStackEntry(struct stackEntry* entry, PredicateResultCode code)
   entry->predicate = *entry->predicates;
   entry->round =
       code == PREDICATE_SUCCESS_NEXT_PREDICATE ? 0 : entry[-1].round + 1;
+  entry->statistics = entry->predicate == entry[-1].predicate
+                          ? entry[-1].statistics
+                          : predicateStatistics(entry->predicate);
   entry->currentChoice = -1;
-  entry->trail = Trail;
+  entry->trail = trailBacktrackPoint();
   entry->counter = Counter++;
 }
 
+static void replayMismatch(int depth, const char* message)
+{
+  struct choicePoint* point = &ReplayPath[depth];
+  fprintf(stderr,
+          "The program does not follow the path: %s at depth %d, %s(%d)",
+          message, depth, stack[depth].predicate->name, stack[depth].round);
+  if (point->predicate != NULL) {
+    fprintf(stderr, ", where the path has %s(%d)", point->predicate,
+            point->round);
+  }
+  fprintf(stderr, "\n");
+  exit(EXIT_FAILURE);
+}
+
+/* Called before each call of a predicate, while following a path. */
+static void replayCall(void)
+{
+  struct choicePoint* point = &ReplayPath[stackTop - stack];
+  if (point->predicate != NULL &&
+      (strcmp(point->predicate, stackTop->predicate->name) != 0 ||
+       point->round != stackTop->round)) {
+    replayMismatch(stackTop - stack, "a different call");
+  }
+  if (point == &ReplayPath[ReplayLength - 1]) {
+    ReplayPath = NULL;
+    if (Replayed != NULL) {
+      Replayed();
+    }
+  }
+}
+
+/* Called after each call of a predicate at depth, while following a path;
+ * with choices, skips to the one in the path. */
+static void replayChoice(int depth, PredicateResult result)
+{
+  int choice = ReplayPath[depth].choice;
+  switch (result.code) {
+    case PREDICATE_SUCCESS_NEXT_PREDICATE:
+    case PREDICATE_SUCCESS_SAME_PREDICATE:
+      if (choice >= 0) {
+        replayMismatch(depth, "no choices");
+      }
+      break;
+    case PREDICATE_CHOICES:
+      if (choice < 0 || choice >= result.numberOfChoices) {
+        replayMismatch(depth, "different choices");
+      }
+      while (stackTop->currentChoice < choice) {
+        freeAll();
+        stackTop->predicate->retry(stackTop->round,
+                                   stackTop->currentChoice++);
+        trailRewindTo(stackTop->trail);
+      }
+      break;
+    default:
+      replayMismatch(depth, "a failure");
+  }
+}
+
+static bool isTask(void)
+{
+  if (stackTop->predicate == SplitPredicate) {
+    return stackTop->round == SplitRound;
+  }
+  return stackTop > stack && stackTop[-1].predicate == SplitPredicate &&
+         stackTop[-1].round < SplitRound;
+}
+
+static void claimTask(void)
+{
+  pthread_mutex_lock(&TasksMutex);
+  TaskClaimed = NextTask++;
+  Active[SearchThread] = TaskClaimed;
+  pthread_mutex_unlock(&TasksMutex);
+}
+
+static void finishTask(void)
+{
+  pthread_mutex_lock(&TasksMutex);
+  Active[SearchThread] = INT_MAX;
+  pthread_cond_broadcast(&TaskFinished);
+  pthread_mutex_unlock(&TasksMutex);
+  TaskDepth = -1;
+}
+
+/**
+ * True if this call is a task that another search thread is doing.
+ * Every thread does the work between the tasks, but only the thread that
+ * claimed the task before counts it, see statisticMark; before the first
+ * task, the thread that claims it does.
+ */
+static bool otherThreadsTask(void)
+{
+  if (SplitPredicate == NULL || !isTask()) {
+    return false;
+  }
+  int task = TasksSeen++;
+  bool counted = task == 0 || TaskClaimed == task - 1;
+  if (task > TaskClaimed) {
+    claimTask();
+  }
+  statisticMark(counted && (task > 0 || TaskClaimed == 0));
+  if (task != TaskClaimed) {
+    return true;
+  }
+  TaskDepth = stackTop - stack;
+  WaitedForEarlierTasks = false;
+  return false;
+}
+
 /**
  * Handles the initial attempt to execute a predicate.
  * Returns false if execution should be suspended.
  */
 static bool callPort(void)
 {
-  PredicateResult result = stackTop->predicate->try(stackTop->round);
+  PredicateResult result;
+  int depth = stackTop - stack;
+  uint64 start = cycleCount();
+  if (ReplayPath != NULL) {
+    replayCall();
+  }
+  if (depth == StopDepth) {
+    Reached();
+    result = PredicateFail;
+  } else if (otherThreadsTask()) {
+    result = PredicateFail;
+  } else {
+    result = stackTop->predicate->try(stackTop->round);
+  }
+  if (stackTop->statistics != NULL) {
+    notePort(&stackTop->statistics->calls, start);
+  }
 
   switch (result.code) {
     case PREDICATE_SUCCESS_NEXT_PREDICATE:
     case PREDICATE_SUCCESS_SAME_PREDICATE:
+      checkStackSize();
       pushStackEntry(++stackTop, result.code);
-      assert(stackTop < stack + MAX_STACK_SIZE);
       break;
 
     case PREDICATE_FAIL: /* 0 choices */
@@ -100,21 +402,47 @@ static bool callPort(void)
       stackTop->inChoiceMode = true;
       stackTop->currentChoice = 0;
       stackTop->numberOfChoices = result.numberOfChoices;
-      stackTop->trail = Trail;
+      stackTop->trail = trailBacktrackPoint();
       break;
     case PREDICATE_SUSPEND:
       return false;
   }
+  if (ReplayPath != NULL) {
+    replayChoice(depth, result);
+  }
   return true;
 }
 
+/**
+ * Outside the subtree, fails without trying the choices left.
+ */
+static void skipChoices(void)
+{
+  if (stackTop->predicate->skip != NULL) {
+    stackTop->predicate->skip(stackTop->round, stackTop->currentChoice);
+  }
+  stackTop->currentChoice = stackTop->numberOfChoices;
+  trailRewindTo(stackTop->trail);
+}
+
 /**
  * Handles subsequent attempts to execute a predicate after initial choices.
  */
 static void retryPort(void)
 {
+  if (OutsideSubtree) {
+    skipChoices();
+    return;
+  }
+  uint64 start = cycleCount();
   PredicateResult result =
       stackTop->predicate->retry(stackTop->round, stackTop->currentChoice++);
+  if (stackTop->statistics != NULL) {
+    notePort(&stackTop->statistics->retries, start);
+  }
+  if (ReplayPath != NULL && result.code == PREDICATE_FAIL) {
+    replayMismatch(stackTop - stack, "a failed choice");
+  }
 
   switch (result.code) {
     case PREDICATE_FAIL:
@@ -123,8 +451,8 @@ static void retryPort(void)
 
     case PREDICATE_SUCCESS_NEXT_PREDICATE:
     case PREDICATE_SUCCESS_SAME_PREDICATE:
+      checkStackSize();
       pushStackEntry(++stackTop, result.code);
-      assert(stackTop < stack + MAX_STACK_SIZE);
       break;
     case PREDICATE_CHOICES:
     case PREDICATE_SUSPEND:
@@ -152,7 +480,18 @@ static bool engineLoop(void)
         /* backtrack */
         do {
           trace("fail");
+          if (stackTop->statistics != NULL) {
+            stackTop->statistics->fails++;
+          }
+          if (stackTop - stack == TaskDepth) {
+            finishTask();
+          }
+          if (stackTop - stack <= SubtreeDepth) {
+            OutsideSubtree = true;
+          }
           if (stackTop == stack) {
+            SubtreeDepth = -1;
+            OutsideSubtree = false;
             return true;  // All done
           }
           stackTop--;
@@ -165,13 +504,63 @@ static bool engineLoop(void)
   }
 }
 
+/**
+ * A thread local pointer cannot be statically initialized with the address of
+ * a thread local array, so we do it on first use in each thread.
+ */
+static void initializeThreadEngine(void)
+{
+  if (stackTop == NULL) {
+    stackTop = stack;
+    TrailArray = mmap(NULL,
+                      (size_t)TRAIL_MAX_SEGMENTS * TRAIL_SEGMENT_SIZE *
+                          sizeof(struct trail),
+                      PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1, 0);
+    if (TrailArray == MAP_FAILED) {
+      perror("mmap");
+      exit(EXIT_FAILURE);
+    }
+    Trail = TrailLimit = TrailArray;
+  }
+}
+
+/* The search threads of engineParallel give back their trail. */
+static void releaseThreadEngine(void)
+{
+  munmap(TrailArray, (size_t)TRAIL_MAX_SEGMENTS * TRAIL_SEGMENT_SIZE *
+                         sizeof(struct trail));
+  TrailArray = TrailLimit = Trail = frozenTrail = NULL;
+  stackTop = NULL;
+}
+
 void initializeTrail()
 {
-  statisticIncludeInteger(&MaxTrailSize, "$", "MaxTrail", true);
+  initializeThreadEngine();
+  statisticIncludeMaximum(&MaxTrailSize, "$", "MaxTrail", true);
+}
+
+/* Makes the next segment of the trail usable. */
+static void trailGrow(void)
+{
+  if (TrailLimit == TrailArray + TRAIL_MAX_SEGMENTS * TRAIL_SEGMENT_SIZE) {
+    fprintf(stderr, "The trail is full, at %d entries\n",
+            TRAIL_MAX_SEGMENTS * TRAIL_SEGMENT_SIZE);
+    exit(EXIT_FAILURE);
+  }
+  if (mprotect(TrailLimit, TRAIL_SEGMENT_SIZE * sizeof(struct trail),
+               PROT_READ | PROT_WRITE) != 0) {
+    perror("mprotect");
+    exit(EXIT_FAILURE);
+  }
+  TrailLimit += TRAIL_SEGMENT_SIZE;
 }
 
 void trailSetPointer(void** ptr, void* value)
 {
+  if (Trail == TrailLimit) {
+    trailGrow();
+  }
   Trail->ptr = ptr;
   Trail->value = (uint_trail)*ptr;
   Trail++;
@@ -180,6 +569,9 @@ void trailSetPointer(void** ptr, void* value)
 
 void trailSetInt(uint_trail* ptr, uint_trail value)
 {
+  if (Trail == TrailLimit) {
+    trailGrow();
+  }
   Trail->ptr = ptr;
   Trail->value = *ptr;
   Trail++;
@@ -193,13 +585,33 @@ void trailMaybeSetInt(uint_trail* ptr, uint_trail value)
   }
 }
 
+void trailSetIntOnce(uint_trail* ptr, uint_trail value, uint64* stamp)
+{
+  if (*stamp != TrailGeneration) {
+    *stamp = TrailGeneration;
+    if (Trail == TrailLimit) {
+      trailGrow();
+    }
+    Trail->ptr = ptr;
+    Trail->value = *ptr;
+    Trail++;
+  }
+  *ptr = value;
+}
+
+TRAIL trailBacktrackPoint(void)
+{
+  TrailGeneration++;
+  return Trail;
+}
+
 /**
  * Freezes the trail at its current point. Backtracking won't go beyond this
  * point.
  */
 void trailFreeze()
 {
-  frozenTrail = Trail;
+  frozenTrail = trailBacktrackPoint();
 }
 
 /**
@@ -212,6 +624,7 @@ bool trailRewindTo(TRAIL backtrackPoint)
     MaxTrailSize = trailSize;
   }
   bool result = false;
+  TrailGeneration++;
   if (backtrackPoint < frozenTrail) {
     backtrackPoint = frozenTrail;
   }
@@ -230,13 +643,15 @@ bool trailRewindTo(TRAIL backtrackPoint)
 void engine(PREDICATE* predicates)
 {
   // Initialize first stack entry
+  initializeThreadEngine();
   assert(stackTop == stack);
   stackTop->inChoiceMode = false;
   stackTop->predicate = *predicates;
   stackTop->predicates = predicates;
+  stackTop->statistics = predicateStatistics(*predicates);
   stackTop->currentChoice = -1;
   stackTop->round = 0;
-  stackTop->trail = Trail;
+  stackTop->trail = trailBacktrackPoint();
   stackTop->counter = Counter++;
 
   if (!engineLoop() && TracingFlag) {
@@ -246,6 +661,87 @@ void engine(PREDICATE* predicates)
   }
 }
 
+static void* searchThread(void* predicates)
+{
+  SearchThread = atomic_fetch_add(&NextSearchThread, 1);
+  engine(predicates);
+  /* The work after the last task, or, if there are none, all of it. */
+  statisticMark(TasksSeen == 0 ? SearchThread == 0
+                               : TaskClaimed == TasksSeen - 1);
+  /* A task claimed after the last one is never searched. */
+  finishTask();
+  statisticSaveThreadTotals();
+  releaseThreadEngine();
+  releaseMemory();
+  return NULL;
+}
+
+/**
+ * Runs the program in numberOfThreads search threads, sharing out the calls
+ * of splitPredicate in round splitRound between them; all other work is
+ * repeated in every thread, but counted once. Every global variable that
+ * the program changes must be THREAD_LOCAL, and the work before each task
+ * must not depend on the tasks before it. The statistics of the threads
+ * are added into those of the calling thread.
+ */
+void engineParallel(PREDICATE* predicates, PREDICATE splitPredicate,
+                    int splitRound, int numberOfThreads)
+{
+  pthread_t threads[numberOfThreads];
+  SplitPredicate = splitPredicate;
+  SplitRound = splitRound;
+  NextTask = 0;
+  NumberOfSearchThreads = numberOfThreads;
+  Active = malloc(numberOfThreads * sizeof(int));
+  if (Active == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < numberOfThreads; i++) {
+    Active[i] = INT_MAX;
+  }
+  atomic_store(&NextSearchThread, 0);
+  for (int i = 0; i < numberOfThreads; i++) {
+    if (pthread_create(&threads[i], NULL, searchThread, predicates) != 0) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  for (int i = 0; i < numberOfThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  SplitPredicate = NULL;
+  free(Active);
+  Active = NULL;
+  statisticAddThreadTotals();
+}
+
+bool engineWaitForEarlierTasks(void)
+{
+  if (SplitPredicate == NULL) {
+    return false;
+  }
+  assert(TaskDepth >= 0);
+  if (!WaitedForEarlierTasks) {
+    pthread_mutex_lock(&TasksMutex);
+    while (true) {
+      int earliest = TaskClaimed;
+      for (int i = 0; i < NumberOfSearchThreads; i++) {
+        if (Active[i] < earliest) {
+          earliest = Active[i];
+        }
+      }
+      if (earliest == TaskClaimed) {
+        break;
+      }
+      pthread_cond_wait(&TaskFinished, &TasksMutex);
+    }
+    pthread_mutex_unlock(&TasksMutex);
+    WaitedForEarlierTasks = true;
+  }
+  return true;
+}
+
 /**
  * Continue from the suspension point, with a new set of predicates.
  * When the new predicates complete, we backtrack through
@@ -258,11 +754,54 @@ void engineResume(PREDICATE* predicates)
   pushStackEntry(++stackTop, PREDICATE_SUCCESS_NEXT_PREDICATE);
   stackTop->predicate = *predicates;
   stackTop->predicates = predicates;
+  stackTop->statistics = predicateStatistics(*predicates);
   successfulRun = engineLoop();
   // Suspending twice is not supported.
   assert(successfulRun);
 }
 
+int enginePath(struct choicePoint* path)
+{
+  int length = stackTop - stack + 1;
+  for (int i = 0; i < length; i++) {
+    path[i].predicate = stack[i].predicate->name;
+    path[i].round = stack[i].round;
+    /* The retry port has already moved on to the next choice. */
+    path[i].choice = stack[i].inChoiceMode ? stack[i].currentChoice - 1 : -1;
+  }
+  return length;
+}
+
+void engineReplay(struct choicePoint* path, int length,
+                  void (*replayed)(void))
+{
+  assert(length > 0 && length <= MAX_STACK_SIZE);
+  ReplayPath = path;
+  ReplayLength = length;
+  Replayed = replayed;
+}
+
+void engineSubtree(struct choicePoint* path, int length)
+{
+  engineReplay(path, length, NULL);
+  SubtreeDepth = length - 1;
+}
+
+struct stackEntry* engineTop(int* depth)
+{
+  struct stackEntry* top = stackTop;
+  if (top != NULL) {
+    *depth = top - stack;
+  }
+  return top;
+}
+
+void engineStopAt(int depth, void (*reached)(void))
+{
+  StopDepth = depth;
+  Reached = reached;
+}
+
 /**
  * Helper macro for defining simple predicates with no retry behavior.
  */
@@ -272,7 +811,7 @@ void engineResume(PREDICATE* predicates)
     (void)round;                                          \
     return (struct predicateResult){PREDICATE_##name, 0}; \
   }                                                       \
-  struct predicate name##Predicate = {#name, try##name, NULL};
+  struct predicate name##Predicate = {#name, try##name, NULL, NULL};
 
 /**
  * A predicate that always fails, used to force backtracking.
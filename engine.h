@@ -65,12 +65,17 @@ struct predicateResult predicateChoices(int numberOfChoices);
  * For both methods, the round is simply an integer that is incremented by
  * the engine from 0 upwards. This allows a predicate to do the same thing
  * multiple times.
+ *
+ * The optional skip is called instead of retry when the choices from choice
+ * on are not tried, see engineSubtree, to undo what retry does not leave on
+ * the trail.
  */
 typedef struct predicate {
   const char* name;                  /* Name for debugging */
   PredicateResult (*try)(int round); /* Initial attempt function */
   PredicateResult (*retry)(int round,
                            int choice); /* Function for trying alternatives */
+  void (*skip)(int round, int choice);  /* Cleanup, or NULL */
 }* PREDICATE;
 
 /* Predefined predicates for ending search sequences */
@@ -89,6 +94,7 @@ struct stackEntry {
   int currentChoice;             /* Current alternative being tried */
   int round;                     /* Current round in this predicate */
   TRAIL trail;                   /* Backtracking trail */
+  struct predicateStatistics* statistics; /* The counters of predicate */
   int counter;                   /* Counter for tracing */
   int numberOfChoices;           /* Total alternatives in this predicate */
 };
@@ -104,11 +110,83 @@ struct stackEntry {
  */
 extern void engine(PREDICATE* predicates);
 
+/**
+ * Like engine, but shares the search between numberOfThreads threads.
+ * Each thread runs the predicates independently, and the threads take
+ * turns at the subtrees below the calls of splitPredicate in round
+ * splitRound, and below the calls after it when it finishes sooner.
+ */
+extern void engineParallel(PREDICATE* predicates, PREDICATE splitPredicate,
+                           int splitRound, int numberOfThreads);
+
+/**
+ * In a search thread of engineParallel, waits until the tasks before the
+ * one it is searching are finished, and returns true; otherwise returns
+ * false. Then, until the task is finished, no later task gets this far, so
+ * e.g. solutions can be numbered in the order of the search.
+ */
+extern bool engineWaitForEarlierTasks(void);
+
 /**
  * Resumes execution from a previously suspended state.
  */
 extern void engineResume(PREDICATE* predicates);
 
+/*--------------------------------------
+ * Paths through the Search
+ *--------------------------------------*/
+
+/* The most predicate calls, including rounds, that can be nested. */
+#define MAX_STACK_SIZE 1000
+
+/* A stack entry, as recorded by enginePath. */
+struct choicePoint {
+  const char* predicate; /* The name of the predicate, or NULL: any call */
+  int round;
+  int choice; /* The choice being tried, or -1 */
+};
+
+/**
+ * Copies the stack, from the bottom up to the predicate being called, into
+ * path, which must have room for MAX_STACK_SIZE entries, and returns its
+ * length.
+ */
+extern int enginePath(struct choicePoint* path);
+
+/**
+ * Makes the engine follow path, rather than search, until it calls the
+ * last predicate of path. At each entry below that, it makes the recorded
+ * choice: the earlier choices are retried and undone, because a retry may
+ * depend on the ones before, but nothing below them is searched. Then
+ * replayed is called, and the engine carries on from the last entry as if
+ * it had got there by searching. The path must come from the same program
+ * with the same options; if the program does not follow it, that is a
+ * fatal error.
+ */
+extern void engineReplay(struct choicePoint* path, int length,
+                         void (*replayed)(void));
+
+/**
+ * Like engineReplay, but then the engine only searches below the last call
+ * of path. When that call fails, the choices left in the entries below it
+ * are not retried, but skipped, so that e.g. the backward functions are run.
+ */
+extern void engineSubtree(struct choicePoint* path, int length);
+
+/**
+ * Returns the top entry of the stack of this thread, and sets depth to its
+ * index, or returns NULL if this thread has not run the engine. This may be
+ * called from a signal handler, e.g. to profile the search.
+ */
+extern struct stackEntry* engineTop(int* depth);
+
+/**
+ * Until engineStopAt(-1, NULL), the engine does not call the predicates at
+ * depth in the stack: it calls reached instead, when enginePath gives the
+ * path to the call, and fails.
+ */
+extern void engineStopAt(int depth, void (*reached)(void));
+
 /*--------------------------------------
  * Predicate Definition Macros
  *--------------------------------------*/
@@ -156,7 +234,16 @@ extern void engineResume(PREDICATE* predicates);
         assert(0);                                                             \
     }                                                                          \
   }                                                                            \
-  scope struct predicate name##Predicate = {#name, try##name, retry##name};
+  static void skip##name(int round, int choice)                                \
+  {                                                                            \
+    (void)round;                                                               \
+    void (*backwardFunction)(void) = backward;                                 \
+    if (choice == 1 && backwardFunction) {                                     \
+      backwardFunction();                                                      \
+    }                                                                          \
+  }                                                                            \
+  scope struct predicate name##Predicate = {#name, try##name, retry##name,     \
+                                            skip##name};
 
 /* Creates a global predicate */
 #define FORWARD_BACKWARD_PREDICATE(name, gate, forward, backward)          \
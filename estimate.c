@@ -0,0 +1,209 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "common.h"
+#include "face.h"
+#include "main.h"
+#include "predicates.h"
+#include "s6.h"
+#include "visible_for_testing.h"
+
+#include <math.h>
+#include <time.h>
+
+/**
+ * Knuth's estimate of the size of the search tree (-e probes). Each probe
+ * goes from the root of the Venn search to a leaf, choosing one of the
+ * possible cycles of each face at random, where the search would try them
+ * all. The sum, over the faces chosen, of the product of the numbers of
+ * possible cycles so far, is an unbiased estimate of the number of guesses
+ * the search makes; and if the leaf is a solution, that product is an
+ * unbiased estimate of the number of solutions. At each face, the probe
+ * also tries every possible cycle, as the search does, and times that: the
+ * sum of those times, each multiplied by the product of the numbers of
+ * possible cycles before it, estimates the time of the search. The mean
+ * over the probes is reported for each face degree signature, with 1.96
+ * standard errors either side. The estimates are heavy tailed: most probes
+ * miss the few deep subtrees that take most of the time, so the mean is
+ * usually too low, and the sample variance understates the spread. This
+ * is not a 95% confidence interval; the true value is often outside it.
+ */
+
+/* 1.96 standard errors, which would be a 95% confidence interval if the
+ * mean were normally distributed. */
+#define STANDARD_ERRORS 1.96
+
+struct estimate {
+  double sum;
+  double sumOfSquares;
+};
+
+extern THREAD_LOCAL FACE_DEGREE CurrentFaceDegrees[NCOLORS];
+static THREAD_LOCAL uint64 Random = 0x9e3779b97f4a7c15ull;
+static THREAD_LOCAL double TotalGuesses, TotalGuessesVariance;
+static THREAD_LOCAL double TotalSolutions, TotalSolutionsVariance;
+static THREAD_LOCAL double TotalSeconds, TotalSecondsVariance;
+
+static uint64 nextRandom(void)
+{
+  Random ^= Random << 13;
+  Random ^= Random >> 7;
+  Random ^= Random << 17;
+  return Random;
+}
+
+static CYCLE randomCycle(FACE face)
+{
+  struct faceState* state = FACE_STATE(face);
+  uint64 n = nextRandom() % state->cycleSetSize;
+  CYCLE cycle = cycleSetFirst(state->possibleCycles);
+  while (n-- > 0) {
+    cycle = cycleSetNext(state->possibleCycles, cycle);
+  }
+  return cycle;
+}
+
+static void estimateAdd(struct estimate* estimate, double value)
+{
+  estimate->sum += value;
+  estimate->sumOfSquares += value * value;
+}
+
+static double estimateMean(struct estimate* estimate)
+{
+  return estimate->sum / EstimateProbesFlag;
+}
+
+/* The variance of the mean. */
+static double estimateVariance(struct estimate* estimate)
+{
+  double mean = estimateMean(estimate);
+  if (EstimateProbesFlag < 2) {
+    return 0.0;
+  }
+  return fmax(0.0, estimate->sumOfSquares / EstimateProbesFlag - mean * mean) /
+         (EstimateProbesFlag - 1);
+}
+
+static double secondsSince(struct timespec* start)
+{
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Does the work of the search at face: tries each of its possible cycles,
+ * and puts everything back. */
+static void tryEveryCycle(FACE face)
+{
+  struct faceState* state = FACE_STATE(face);
+  CYCLE cycle;
+  for (cycle = cycleSetFirst(state->possibleCycles); cycle != NULL;
+       cycle = cycleSetNext(state->possibleCycles, cycle)) {
+    TRAIL trail = trailBacktrackPoint();
+    TRAIL_SET_POINTER(&state->cycle, cycle);
+    (void)dynamicFaceBacktrackableChoice(face);
+    trailRewindTo(trail);
+  }
+}
+
+/* Like the loop of VennPredicate, making one choice at each round. */
+static void probe(struct estimate* guesses, struct estimate* solutions,
+                  struct estimate* seconds)
+{
+  TRAIL trail = trailBacktrackPoint();
+  double product = 1.0, sum = 0.0, solution = 0.0, time = 0.0;
+  struct timespec start;
+  FACE face;
+  bool leaf;
+  while (true) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    leaf = false;
+#if NCOLORS == 6
+    leaf = s6PrefixIsNonCanonical();
+#endif
+    face = leaf ? NULL : searchChooseNextFace();
+    if (face == NULL) {
+      if (!leaf && dynamicFaceFinalCorrectnessChecks() == NULL) {
+        solution = product;
+      }
+      leaf = true;
+    } else {
+      tryEveryCycle(face);
+    }
+    /* product is the estimated number of nodes like this one. */
+    time += product * secondsSince(&start);
+    if (leaf || FACE_STATE(face)->cycleSetSize == 0) {
+      break;
+    }
+    product *= FACE_STATE(face)->cycleSetSize;
+    sum += product;
+    TRAIL_SET_POINTER(&FACE_STATE(face)->cycle, randomCycle(face));
+    if (dynamicFaceBacktrackableChoice(face) != NULL) {
+      break;
+    }
+  }
+  estimateAdd(guesses, sum);
+  estimateAdd(solutions, solution);
+  estimateAdd(seconds, time);
+  trailRewindTo(trail);
+}
+
+void estimatePrintHeading(void)
+{
+  printf("Face Degree | Guesses ± 1.96 s.e. | Solutions ± 1.96 s.e. | "
+         "Seconds ± 1.96 s.e.\n");
+  printf("------ | --- | -- | --\n");
+}
+
+static void printEstimate(const char* signature, double guesses,
+                          double guessesVariance, double solutions,
+                          double solutionsVariance, double seconds,
+                          double secondsVariance)
+{
+  printf("%s | %.3g ± %.2g | %.3g ± %.2g | %.3g ± %.2g\n", signature, guesses,
+         STANDARD_ERRORS * sqrt(guessesVariance), solutions,
+         STANDARD_ERRORS * sqrt(solutionsVariance), seconds,
+         STANDARD_ERRORS * sqrt(secondsVariance));
+}
+
+/* Prints the sum of the estimates of each signature. */
+void estimatePrintTotals(void)
+{
+  printEstimate("Total", TotalGuesses, TotalGuessesVariance, TotalSolutions,
+                TotalSolutionsVariance, TotalSeconds, TotalSecondsVariance);
+  printf("\nThe ± understates the spread of these heavy tailed estimates, "
+         "which are\nusually too low: the true values are often outside "
+         "it.\n");
+}
+
+/**
+ * Replaces the VennPredicate: estimates the search of the current face
+ * degree signature, prints the estimate, and fails.
+ */
+static struct predicateResult tryEstimate(int round)
+{
+  struct estimate guesses = {0.0, 0.0}, solutions = {0.0, 0.0},
+                  seconds = {0.0, 0.0};
+  char signature[NCOLORS + 1];
+  (void)round;
+  for (int i = 0; i < NCOLORS; i++) {
+    signature[i] = '0' + CurrentFaceDegrees[i];
+  }
+  signature[NCOLORS] = '\0';
+  for (int i = 0; i < EstimateProbesFlag; i++) {
+    probe(&guesses, &solutions, &seconds);
+  }
+  printEstimate(signature, estimateMean(&guesses),
+                estimateVariance(&guesses), estimateMean(&solutions),
+                estimateVariance(&solutions), estimateMean(&seconds),
+                estimateVariance(&seconds));
+  TotalGuesses += estimateMean(&guesses);
+  TotalGuessesVariance += estimateVariance(&guesses);
+  TotalSolutions += estimateMean(&solutions);
+  TotalSolutionsVariance += estimateVariance(&solutions);
+  TotalSeconds += estimateMean(&seconds);
+  TotalSecondsVariance += estimateVariance(&seconds);
+  return PredicateFail;
+}
+
+struct predicate EstimatePredicate = {"Estimate", tryEstimate, NULL, NULL};
@@ -9,6 +9,7 @@
 
 struct face Faces[NFACES];
 uint64 FaceSumOfFaceDegree[NCOLORS + 1];
+MEMO uint64 ZobristKeys[NFACES][NCYCLES];
 
 static void initializeLengthOfCycleOfFaces(void)
 {
@@ -20,6 +21,20 @@ static void initializeLengthOfCycleOfFaces(void)
   }
 }
 
+static void initializeZobristKeys(void)
+{
+  uint64 state = 0x9e3779b97f4a7c15ull;
+  for (uint32_t i = 0; i < NFACES; i++) {
+    for (uint32_t j = 0; j < NCYCLES; j++) {
+      /* splitmix64 */
+      uint64 z = (state += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      ZobristKeys[i][j] = z ^ (z >> 31);
+    }
+  }
+}
+
 static bool isCycleValidForFace(CYCLE cycle, COLORSET faceColors)
 {
   return (cycle->colors & faceColors) != 0 &&
@@ -108,7 +123,7 @@ static void applyMonotonicity(void)
     for (uint32_t cycleId = 0; cycleId < NCYCLES; cycleId++) {
       CYCLE cycle = Cycles + cycleId;
       if (!isCycleValidForFace(cycle, faceColors)) {
-        cycleSetRemove(cycleId, face->possibleCycles);
+        cycleSetRemove(cycleId, FACE_STATE(face)->possibleCycles);
         continue;
       }
 
@@ -117,7 +132,7 @@ static void applyMonotonicity(void)
           cycle, faceColors, &previousFaceColors, &nextFaceColors);
 
       if (!twoTransitions) {
-        cycleSetRemove(cycleId, face->possibleCycles);
+        cycleSetRemove(cycleId, FACE_STATE(face)->possibleCycles);
       } else {
         assert(previousFaceColors);
         assert(nextFaceColors);
@@ -161,10 +176,11 @@ char* faceToString(FACE face)
 {
   char* buffer = getBuffer();
   char* colorBuf = colorSetToString(face->colors);
-  char* cycleBuf = cycleToString(face->cycle);
+  struct faceState* state = FACE_STATE(face);
+  char* cycleBuf = cycleToString(state->cycle);
 
-  if (face->cycleSetSize > 1) {
-    sprintf(buffer, "%s%s^%llu", colorBuf, cycleBuf, face->cycleSetSize);
+  if (state->cycleSetSize > 1) {
+    sprintf(buffer, "%s%s^%llu", colorBuf, cycleBuf, state->cycleSetSize);
   } else {
     sprintf(buffer, "%s%s", colorBuf, cycleBuf);
   }
@@ -189,7 +205,7 @@ void facePrintSelected(void)
   uint32_t i;
   FACE face;
   for (i = 0, face = Faces; i < NFACES; i++, face++) {
-    if (face->cycle || face->cycleSetSize < 2) {
+    if (FACE_STATE(face)->cycle || FACE_STATE(face)->cycleSetSize < 2) {
       facePrint(face);
     }
   }
@@ -201,13 +217,12 @@ void initializeFacesAndEdges(void)
   FACE face, adjacent;
   EDGE edge;
   if (Faces[1].colors == 0) {
-    statisticIncludeInteger(&CycleForcedCounter, "+", "forced", false);
-    statisticIncludeInteger(&CycleSetReducedCounter, "-", "reduced", true);
     initializeLengthOfCycleOfFaces();
+    initializeZobristKeys();
     for (facecolors = 0, face = Faces; facecolors < NFACES;
          facecolors++, face++) {
       face->colors = facecolors;
-      initializeCycleSetUniversal(face->possibleCycles);
+      initializeCycleSetUniversal(Context.faces[facecolors].possibleCycles);
 
       for (color = 0; color < NCOLORS; color++) {
         uint32_t colorbit = (1 << color);
@@ -221,5 +236,6 @@ void initializeFacesAndEdges(void)
     }
     applyMonotonicity();
     initializePossiblyTo();
+    initializeFaceQueue();
   }
 }
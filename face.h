@@ -15,9 +15,15 @@ extern struct face Faces[NFACES];
  */
 extern uint64 FaceSumOfFaceDegree[NCOLORS + 1];
 
+/* Random keys for each face and cycle, see nogood.c. */
+extern MEMO uint64 ZobristKeys[NFACES][NCYCLES];
+
 /* Dynamic search functions - used in the solving algorithm */
 extern FAILURE dynamicFaceBacktrackableChoice(FACE face);
-extern FAILURE dynamicFaceChoice(FACE face, int depth);
+/* Queues a face whose cycle has been set, to be propagated later. */
+extern void dynamicFaceChoice(FACE face, int depth);
+/* Propagates the queued faces, until none are left, or there is a failure. */
+extern FAILURE dynamicFacePropagate(void);
 
 /* Core face operations */
 extern void initializeFacesAndEdges(void);
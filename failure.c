@@ -11,54 +11,61 @@ this was unnecessary.
 */
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 
-static Failure NoMatchFailure = {
+static THREAD_LOCAL Failure NoMatchFailure = {
     .shortLabel = "N",
     .label = "No matching cycles",
     .count = {0},
 };
 
-static Failure CrossingLimitFailure = {
+static THREAD_LOCAL Failure CrossingLimitFailure = {
     .shortLabel = "X",
     .label = "More than 3 crossing points",
     .count = {0},
 };
 
-static Failure DisconnectedCurveFailure = {
+static THREAD_LOCAL Failure DisconnectedCurveFailure = {
     .shortLabel = "D",
     .label = "Disconnected curve",
     .count = {0},
 };
 
-static Failure TooManyCornersFailure = {
+static THREAD_LOCAL Failure TooManyCornersFailure = {
     .shortLabel = "T",
     .label = "Too many corners",
     .count = {0},
 };
 
-static Failure VertexConflictFailure = {
+static THREAD_LOCAL Failure VertexConflictFailure = {
     .shortLabel = "P",
     .label = "Vertex conflict",
     .count = {0},
 };
 
-static Failure ConflictingConstraintsFailure = {
+static THREAD_LOCAL Failure ConflictingConstraintsFailure = {
     .shortLabel = "C",
     .label = "Conflicting constraints",
     .count = {0},
 };
 
-static Failure DisconnectedFacesFailure = {
+static THREAD_LOCAL Failure DisconnectedFacesFailure = {
     .shortLabel = "F",
     .label = "Disconnected faces",
     .count = {0},
 };
 
-static Failure NonCanoncialFailure = {
+static THREAD_LOCAL Failure NonCanoncialFailure = {
     .shortLabel = "=",
     .label = "Non Canonical",
     .count = {0},
 };
 
+THREAD_LOCAL int FailureCountingSuspended = 0;
+
+#define COUNT_FAILURE(failure, depth) \
+  if (FailureCountingSuspended == 0) {  \
+    (failure).count[depth]++;         \
+  }
+
 /* Externally linked functions - initialize... */
 void initializeFailures(void)
 {
@@ -75,48 +82,48 @@ void initializeFailures(void)
 /* Externally linked functions - failure... */
 FAILURE failureConflictingConstraints(int depth)
 {
-  ConflictingConstraintsFailure.count[depth]++;
+  COUNT_FAILURE(ConflictingConstraintsFailure, depth);
   return &ConflictingConstraintsFailure;
 }
 
 FAILURE failureCrossingLimit(int depth)
 {
-  CrossingLimitFailure.count[depth]++;
+  COUNT_FAILURE(CrossingLimitFailure, depth);
   return &CrossingLimitFailure;
 }
 
 FAILURE failureDisconnectedCurve(int depth)
 {
-  DisconnectedCurveFailure.count[depth]++;
+  COUNT_FAILURE(DisconnectedCurveFailure, depth);
   return &DisconnectedCurveFailure;
 }
 
 FAILURE failureDisconnectedFaces(int depth)
 {
-  DisconnectedFacesFailure.count[depth]++;
+  COUNT_FAILURE(DisconnectedFacesFailure, depth);
   return &DisconnectedFacesFailure;
 }
 
 FAILURE failureNoMatchingCycles(int depth)
 {
-  NoMatchFailure.count[depth]++;
+  COUNT_FAILURE(NoMatchFailure, depth);
   return &NoMatchFailure;
 }
 
 FAILURE failureNonCanonical(void)
 {
-  NonCanoncialFailure.count[0]++;
+  COUNT_FAILURE(NonCanoncialFailure, 0);
   return &NonCanoncialFailure;
 }
 
 FAILURE failureVertexConflict(int depth)
 {
-  VertexConflictFailure.count[depth]++;
+  COUNT_FAILURE(VertexConflictFailure, depth);
   return &VertexConflictFailure;
 }
 
 FAILURE failureTooManyCorners(int depth)
 {
-  TooManyCornersFailure.count[depth]++;
+  COUNT_FAILURE(TooManyCornersFailure, depth);
   return &TooManyCornersFailure;
 }
@@ -32,6 +32,10 @@ typedef struct failure Failure, *FAILURE;
     return failure;         \
   }
 
+/* While positive, failures are not counted: e.g. when nogood.c replays
+ * choices. */
+extern THREAD_LOCAL int FailureCountingSuspended;
+
 /* Initialization */
 extern void initializeFailures(void);
 
@@ -1,20 +1,28 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#define _GNU_SOURCE
+#include "archive.h"
 #include "common.h"
+#include "compact.h"
+#include "compress.h"
+#include "context.h"
 #include "main.h"
 #include "predicates.h"
 #include "triangles.h"
 #include "utils.h"
+#include "writer.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #define DEBUG 0
 
 /* Global variables */
-uint64 GlobalVariantCountIPC = 0;
-char CurrentPrefixIPC[1024];
-int VariationNumberIPC = 1;
-int LevelsIPC = 0;
+THREAD_LOCAL uint64 GlobalVariantCountIPC = 0;
+THREAD_LOCAL char CurrentPrefixIPC[1024];
+THREAD_LOCAL int VariationNumberIPC = 1;
+THREAD_LOCAL int LevelsIPC = 0;
+THREAD_LOCAL FILE *CompactFileIPC = NULL;
 
 struct graphmlFileIO GraphmlFileOps = {fopen, initializeFolder};
 
@@ -58,7 +66,7 @@ static char *cornerId(COLOR color, int counter)
  * Writes the beginning of a GraphML document, including XML declaration,
  * namespaces, and attribute definitions.
  */
-static void graphmlBegin(FILE *fp)
+void graphmlBegin(FILE *fp)
 {
   fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
   fprintf(fp, "<graphml xmlns=\"%s\"\n", GRAPHML_NS);
@@ -169,8 +177,8 @@ static void graphmlAddEdge(FILE *fp, EDGE edge, int line)
   if (!IS_CLOCKWISE_EDGE(edge)) {
     edge = edge->reversed;
   }
-  char *source = graphmlVertexId(edge->reversed->to->vertex);
-  char *target = graphmlVertexId(edge->to->vertex);
+  char *source = graphmlVertexId(EDGE_TO(edge->reversed)->vertex);
+  char *target = graphmlVertexId(EDGE_TO(edge)->vertex);
   addEdge(fp, edge->color, line, source, target);
 }
 
@@ -179,7 +187,7 @@ static void graphmlAddEdge(FILE *fp, EDGE edge, int line)
  */
 static void addEdgeToCorner(FILE *fp, EDGE edge, int corner, int line)
 {
-  char *source = graphmlVertexId(edge->reversed->to->vertex);
+  char *source = graphmlVertexId(EDGE_TO(edge->reversed)->vertex);
   char *target = cornerId(edge->color, corner);
   assert(line != corner);
   addEdge(fp, edge->color, line, source, target);
@@ -202,7 +210,7 @@ static void addEdgeBetweenCorners(FILE *fp, COLOR color, int low, int high)
 static void addEdgeFromCorner(FILE *fp, int corner, EDGE edge, int line)
 {
   char *source = cornerId(edge->color, corner);
-  char *target = graphmlVertexId(edge->to->vertex);
+  char *target = graphmlVertexId(EDGE_TO(edge)->vertex);
   assert(line != corner);
   addEdge(fp, edge->color, line, source, target);
 }
@@ -214,7 +222,7 @@ static void processRegularEdgeGraphML(void *data, EDGE current, int line)
 {
   GraphMLData *gml = (GraphMLData *)data;
   graphmlAddEdge(gml->fp, current, line);
-  addVertexIfPrimary(gml->fp, current->to->vertex, gml->color);
+  addVertexIfPrimary(gml->fp, EDGE_TO(current)->vertex, gml->color);
 }
 
 /**
@@ -228,7 +236,7 @@ static void processSingleCornerGraphML(void *data, EDGE current, int line)
   line = (line + 1) % 3;
   addEdgeFromCorner(gml->fp, gml->cornerIds[gml->cornerIx], current, line);
   gml->cornerIx++;
-  addVertexIfPrimary(gml->fp, current->to->vertex, gml->color);
+  addVertexIfPrimary(gml->fp, EDGE_TO(current)->vertex, gml->color);
 }
 
 /**
@@ -248,7 +256,7 @@ static void processAdjacentCornersGraphML(void *data, EDGE current, int line)
   line = (line + 1) % 3;
   addEdgeFromCorner(gml->fp, gml->cornerIds[gml->cornerIx + 1], current, line);
   gml->cornerIx += 2;
-  addVertexIfPrimary(gml->fp, current->to->vertex, gml->color);
+  addVertexIfPrimary(gml->fp, EDGE_TO(current)->vertex, gml->color);
 }
 
 /**
@@ -266,14 +274,14 @@ static void processAllCornersGraphML(void *data, EDGE current, int line)
   addEdgeBetweenCorners(gml->fp, gml->color, 0, 1);
   addEdgeBetweenCorners(gml->fp, gml->color, 1, 2);
   addEdgeFromCorner(gml->fp, 2, current, 1);
-  addVertexIfPrimary(gml->fp, current->to->vertex, gml->color);
+  addVertexIfPrimary(gml->fp, EDGE_TO(current)->vertex, gml->color);
 }
 
 /**
  * Generates a file path for the current variation based on the variation
  * number.
  */
-static char *subFilename(void)
+char *graphmlVariationFilename(void)
 {
   char *buffer = getBuffer();
   int levels = LevelsIPC;
@@ -314,26 +322,78 @@ static void saveTriangle(FILE *fp, COLOR color, EDGE (*corners)[3])
   addCornerNodes(fp, corners, color, gml.cornerIds);
 }
 
+static void writeGraphml(FILE *fp, EDGE (*corners)[3])
+{
+  COLOR a;
+  graphmlBegin(fp);
+  for (a = 0; a < NCOLORS; a++, corners++) {
+    saveTriangle(fp, a, corners);
+  }
+  graphmlEnd(fp);
+}
+
+static void writeVariation(char *filename, EDGE (*corners)[3])
+{
+  FILE *fp = GraphmlFileOps.fopen(filename, "w");
+  writeGraphml(fp, corners);
+  fclose(fp);
+}
+
+/* The GraphML of the variation, as malloc'ed memory. */
+static char *formatVariation(EDGE (*corners)[3], size_t *length)
+{
+  char *data;
+  FILE *fp = open_memstream(&data, length);
+  if (fp == NULL) {
+    perror("open_memstream");
+    exit(EXIT_FAILURE);
+  }
+  writeGraphml(fp, corners);
+  fclose(fp);
+  return data;
+}
+
+/**
+ * Writes variation VariationNumberIPC of the current solution to its GraphML
+ * file.
+ */
+void graphmlWriteVariation(EDGE (*corners)[3])
+{
+  writeVariation(graphmlVariationFilename(), corners);
+}
+
 /**
- * Saves the current variation to a GraphML file.
+ * Saves the current variation to a GraphML file, directly or by a writer
+ * thread, or to the compact file, the archive or the compressed file of the
+ * solution.
  */
 static void saveVariation(EDGE (*corners)[3])
 {
-  COLOR a;
-  char *filename = subFilename();
-  FILE *fp;
+  char *filename = CompactOutputFlag || ArchiveOutputFlag ||
+                           CompressOutputFlag || NumberOfWriterThreadsFlag > 0
+                       ? NULL
+                       : graphmlVariationFilename();
+  char *data;
+  size_t length;
   VariationNumberIPC++;
   if (VariationNumberIPC - 1 <= IgnoreFirstVariantsPerSolution) {
     return;
   }
   GlobalVariantCountIPC++;
-  fp = GraphmlFileOps.fopen(filename, "w");
-  graphmlBegin(fp);
-  for (a = 0; a < NCOLORS; a++, corners++) {
-    saveTriangle(fp, a, corners);
+  if (CompactOutputFlag) {
+    compactWriteVariation(CompactFileIPC, VariationNumberIPC - 1, corners);
+  } else if (ArchiveOutputFlag) {
+    data = formatVariation(corners, &length);
+    archiveWrite(&ArchiveIPC, VariationNumberIPC - 1, data, length);
+    free(data);
+  } else if (CompressOutputFlag) {
+    data = formatVariation(corners, &length);
+    compressWrite(&CompressorIPC, VariationNumberIPC - 1, data, length);
+  } else if (NumberOfWriterThreadsFlag > 0) {
+    writerWrite(corners);
+  } else {
+    writeVariation(filename, corners);
   }
-  graphmlEnd(fp);
-  fclose(fp);
 }
 
 /**
@@ -355,9 +415,9 @@ int numberOfLevels(int expectedVariations)
 static struct predicateResult trySaveVariation(int round)
 {
   (void)round;  // Unused parameter
-  saveVariation(SelectedCornersIPC);
+  saveVariation(Context.selectedCorners);
   return PredicateSuccessNextPredicate;
 }
 
 /* GraphML predicate for non-deterministic program */
-struct predicate GraphMLPredicate = {"GraphML", trySaveVariation, NULL};
+struct predicate GraphMLPredicate = {"GraphML", trySaveVariation, NULL, NULL};
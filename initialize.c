@@ -2,27 +2,46 @@
 #include "common.h"
 #include "face.h"
 #include "main.h"
+#include "nogood.h"
 #include "predicates.h"
+#include "profile.h"
 #include "s6.h"
 #include "statistics.h"
 #include "utils.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/*
+ * The MEMO data is shared by all threads. This is done by the first
+ * thread to initialize, which also computes the initial search context.
+ */
+static void initializeMemo(void)
+{
+  initializeCycleSets();
+  initializeFacesAndEdges();
+  initializePoints();
+  initializeS6();
+  initializeContextSaveInitial();
+}
+
 void initialize(void)
 {
+  static pthread_once_t MemoOnce = PTHREAD_ONCE_INIT;
   /* Architecture-specific assertions */
   assert((sizeof(uint64) == sizeof(void *)));
   assert(sizeof(uint64) == 8);
 
-  initializeCycleSets();
-  initializeFacesAndEdges();
-  initializePoints();
+  /* First, since the other initializations use the trail. */
   initializeTrail();
+  pthread_once(&MemoOnce, initializeMemo);
+  initializeContext();
+  statisticIncludeInteger(&CycleForcedCounter, "+", "forced", false);
+  statisticIncludeInteger(&CycleSetReducedCounter, "-", "reduced", true);
   initializeMemory();
-  initializeS6();
+  initializeFailures();
   trailFreeze();
 }
 
@@ -32,6 +51,12 @@ static bool forwardInitialize(void)
   statisticIncludeInteger(&CycleGuessCounterIPC, "?", "guesses", false);
   statisticIncludeInteger(&GlobalVariantCountIPC, "V", "variants", false);
   statisticIncludeInteger(&GlobalSolutionsFoundIPC, "S", "solutions", false);
+  if (NogoodsFlag) {
+    initializeNogoods();
+  }
+  if (ProfileFlag) {
+    initializeProfile();
+  }
   return true;
 }
 
@@ -11,8 +11,8 @@
  */
 #define TOTAL_5FACE_DEGREE 27
 
-extern FACE_DEGREE CurrentFaceDegrees[NCOLORS];
-FACE_DEGREE CurrentFaceDegrees[NCOLORS];
+extern THREAD_LOCAL FACE_DEGREE CurrentFaceDegrees[NCOLORS];
+THREAD_LOCAL FACE_DEGREE CurrentFaceDegrees[NCOLORS];
 
 static int sumFaceDegree(int round)
 {
@@ -62,5 +62,42 @@ static struct predicateResult retry5FaceDegree(int round, int choice)
   return PredicateSuccessSamePredicate;
 }
 
+static void addSignatures(int position, FACE_DEGREE* degrees, int sum,
+                          FACE_DEGREE (*signatures)[NCOLORS], int* count)
+{
+  if (position == NCOLORS) {
+    if (sum == TOTAL_5FACE_DEGREE &&
+        s6SymmetryType6(degrees) != NON_CANONICAL) {
+      memcpy(signatures[(*count)++], degrees, sizeof(FACE_DEGREE) * NCOLORS);
+    }
+    return;
+  }
+  /* In the same order as retry5FaceDegree. */
+  for (int degree = NCOLORS; degree >= 3; degree--) {
+    if (CentralFaceDegreesFlag[position] > 0 &&
+        (FACE_DEGREE)degree != CentralFaceDegreesFlag[position]) {
+      continue;
+    }
+    if (sum + degree + 3 * (NCOLORS - position - 1) > TOTAL_5FACE_DEGREE) {
+      continue;
+    }
+    degrees[position] = degree;
+    addSignatures(position + 1, degrees, sum + degree, signatures, count);
+  }
+}
+
+/**
+ * Fills signatures with the face degree signatures tried by the InnerFaces
+ * predicate, in the same order, and returns how many there are. There are
+ * at most MAX_SIGNATURES.
+ */
+int innerFaceSignatures(FACE_DEGREE (*signatures)[NCOLORS])
+{
+  FACE_DEGREE degrees[NCOLORS];
+  int count = 0;
+  addSignatures(0, degrees, 0, signatures, &count);
+  return count;
+}
+
 struct predicate InnerFacePredicate = {"InnerFaces", dynamicTry5FaceDegree,
-                                       retry5FaceDegree};
+                                       retry5FaceDegree, NULL};
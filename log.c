@@ -1,21 +1,41 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#define _GNU_SOURCE
 #include "common.h"
 #include "main.h"
 #include "predicates.h"
 #include "statistics.h"
 
-extern FACE_DEGREE CurrentFaceDegrees[NCOLORS];
-static clock_t TotalWastedTime = 0;
-static clock_t TotalUsefulTime = 0;
-static int WastedSearchCount = 0;
-static int UsefulSearchCount = 0;
-static int FacePredicateRecentSolutionsFound = 0;
-static int FacePredicateInitialVariationCount = 0;
-static clock_t FacePredicateStart = 0;
+#include <pthread.h>
+
+extern THREAD_LOCAL FACE_DEGREE CurrentFaceDegrees[NCOLORS];
+static THREAD_LOCAL clock_t TotalWastedTime = 0;
+static THREAD_LOCAL clock_t TotalUsefulTime = 0;
+static THREAD_LOCAL int WastedSearchCount = 0;
+static THREAD_LOCAL int UsefulSearchCount = 0;
+static THREAD_LOCAL int FacePredicateRecentSolutionsFound = 0;
+static THREAD_LOCAL int FacePredicateInitialVariationCount = 0;
+static THREAD_LOCAL clock_t FacePredicateStart = 0;
+
+/*
+ * With logShareSignatures, the search threads each run the Log predicate
+ * for every face degree signature, in the same order, and add what they
+ * found to its entry; the last of them logs the signature. The solutions
+ * are numbered here, see logNumberSolution. Protected by SignaturesMutex.
+ */
+static pthread_mutex_t SignaturesMutex = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+  int solutionsNumbered;
+  uint64 solutions;
+  int variations;
+  int threads;
+} Signatures[MAX_SIGNATURES];
+static int SharingThreads = 0;
+static THREAD_LOCAL int SignatureNumber = -1;
 
 static bool forwardLog(void)
 {
+  SignatureNumber++;
   FacePredicateStart = clock();
   FacePredicateRecentSolutionsFound = GlobalSolutionsFoundIPC;
   FacePredicateInitialVariationCount = VariationCountIPC;
@@ -25,9 +45,27 @@ static bool forwardLog(void)
 static void backwardLog(void)
 {
   clock_t used = clock() - FacePredicateStart;
-  if ((int64_t)GlobalSolutionsFoundIPC != FacePredicateRecentSolutionsFound) {
+  uint64 solutions =
+      GlobalSolutionsFoundIPC - FacePredicateRecentSolutionsFound;
+  int variations = VariationCountIPC - FacePredicateInitialVariationCount;
+  FacePredicateRecentSolutionsFound = GlobalSolutionsFoundIPC;
+  if (SharingThreads > 0) {
+    assert(SignatureNumber < MAX_SIGNATURES);
+    pthread_mutex_lock(&SignaturesMutex);
+    Signatures[SignatureNumber].solutions += solutions;
+    Signatures[SignatureNumber].variations += variations;
+    bool last = ++Signatures[SignatureNumber].threads == SharingThreads;
+    solutions = Signatures[SignatureNumber].solutions;
+    variations = Signatures[SignatureNumber].variations;
+    pthread_mutex_unlock(&SignaturesMutex);
+    if (!last) {
+      return;
+    }
+  }
+  if (solutions != 0) {
     TotalUsefulTime += used;
     UsefulSearchCount += 1;
+    flockfile(stdout);
 
 #define PRINT_TIME(clockValue, counter)                        \
   printf("[%1lu.%6.6lu (%d)] ", (clockValue) / CLOCKS_PER_SEC, \
@@ -40,15 +78,28 @@ static void backwardLog(void)
     for (int i = 0; i < NCOLORS; i++) {
       printf("%llu ", CurrentFaceDegrees[i]);
     }
-    printf(" gives %llu/%d new solutions\n",
-           GlobalSolutionsFoundIPC - FacePredicateRecentSolutionsFound,
-           VariationCountIPC - FacePredicateInitialVariationCount);
+    printf(" gives %llu/%d new solutions\n", solutions, variations);
+    funlockfile(stdout);
     statisticPrintOneLine(0, false);
   } else {
     WastedSearchCount += 1;
     TotalWastedTime += used;
   }
-  FacePredicateRecentSolutionsFound = GlobalSolutionsFoundIPC;
 }
 
 FORWARD_BACKWARD_PREDICATE(Log, NULL, forwardLog, backwardLog);
+
+void logShareSignatures(int numberOfThreads)
+{
+  memset(Signatures, 0, sizeof(Signatures));
+  SharingThreads = numberOfThreads;
+}
+
+int logNumberSolution(void)
+{
+  if (SharingThreads == 0) {
+    return PerFaceDegreeSolutionNumberIPC + 1;
+  }
+  /* Only one thread at a time gets here, see engineWaitForEarlierTasks. */
+  return ++Signatures[SignatureNumber].solutionsNumbered;
+}
@@ -2,10 +2,19 @@
 
 #include "main.h"
 
+#include "archive.h"
+#include "checkpoint.h"
+#include "compact.h"
+#include "compress.h"
 #include "engine.h"
+#include "multiprocess.h"
 #include "nondeterminism.h"
+#include "predicates.h"
+#include "profile.h"
 #include "statistics.h"
+#include "subtree.h"
 #include "utils.h"
+#include "writer.h"
 
 #include <getopt.h>
 #include <limits.h>
@@ -22,6 +31,22 @@ int IgnoreFirstVariantsPerSolution = 0;
 FACE_DEGREE CentralFaceDegreesFlag[NCOLORS] = {0};
 bool VerboseModeFlag = false;
 bool TracingFlag = false;
+int NumberOfThreadsFlag = 1;
+int SplitRoundFlag = 5;
+int NumberOfProcessesFlag = 1;
+int NumberOfWriterThreadsFlag = 0;
+bool CompactOutputFlag = false;
+bool ArchiveOutputFlag = false;
+bool CompressOutputFlag = false;
+char *ExpandFileFlag = NULL;
+bool CountOnlyFlag = false;
+bool NogoodsFlag = false;
+int EstimateProbesFlag = 0;
+char *CheckpointFileFlag = NULL;
+char *SubtreeAddressFlag = NULL;
+int SplitDepthFlag = 0;
+char *StatisticsStreamFlag = NULL;
+bool ProfileFlag = false;
 
 static void setFaceDegrees(const char *programName, const char *faceDegrees)
 {
@@ -48,7 +73,7 @@ static int parsePositiveArgument(const char *programName, const char *arg,
   sprintf(errorMessage, "-%c must be a %s integer.", flag,
           allowZero ? "non-negative" : "positive");
   int value = strtol(arg, &endptr, 10);
-  if (value <= 0) {
+  if (value < 0) {
     disaster(programName, errorMessage);
   }
   if (endptr == arg) {
@@ -63,6 +88,13 @@ static int parsePositiveArgument(const char *programName, const char *arg,
   return value;
 }
 
+static bool hasExtension(const char *filename, const char *extension)
+{
+  size_t length = strlen(filename), extensionLength = strlen(extension);
+  return length > extensionLength &&
+         strcmp(filename + length - extensionLength, extension) == 0;
+}
+
 static void initializeOutputFolder()
 {
   initializeFolder(TargetFolderFlag);
@@ -71,13 +103,31 @@ static void initializeOutputFolder()
 int realMain0(int argc, char *argv[])
 {
   int opt;
+  struct predicate **program = NonDeterministicProgram;
   TargetFolderFlag = NULL;
+  NumberOfThreadsFlag = 1;
+  SplitRoundFlag = 5;
+  NumberOfProcessesFlag = 1;
+  NumberOfWriterThreadsFlag = 0;
+  CompactOutputFlag = false;
+  ArchiveOutputFlag = false;
+  CompressOutputFlag = false;
+  ExpandFileFlag = NULL;
+  CountOnlyFlag = false;
+  NogoodsFlag = false;
+  EstimateProbesFlag = 0;
+  CheckpointFileFlag = NULL;
+  SubtreeAddressFlag = NULL;
+  SplitDepthFlag = 0;
+  StatisticsStreamFlag = NULL;
+  ProfileFlag = false;
   bool hasFaceDegrees = false;
   int localMaxSolutions = INT_MAX;
   int localSkipSolutions = 0;
   char *programName = argv[0];
 
-  while ((opt = getopt(argc, argv, "f:d:m:n:k:j:vt")) != -1) {
+  while ((opt = getopt(argc, argv,
+                       "f:d:m:n:k:j:T:R:P:w:cazCge:r:s:S:J:px:vt")) != -1) {
     switch (opt) {
       case 'f':
         TargetFolderFlag = optarg;
@@ -102,6 +152,59 @@ int realMain0(int argc, char *argv[])
         IgnoreFirstVariantsPerSolution =
             parsePositiveArgument(programName, optarg, 'j', true);
         break;
+      case 'T':
+        NumberOfThreadsFlag =
+            parsePositiveArgument(programName, optarg, 'T', false);
+        break;
+      case 'R':
+        SplitRoundFlag =
+            parsePositiveArgument(programName, optarg, 'R', true);
+        break;
+      case 'P':
+        NumberOfProcessesFlag =
+            parsePositiveArgument(programName, optarg, 'P', false);
+        break;
+      case 'w':
+        NumberOfWriterThreadsFlag =
+            parsePositiveArgument(programName, optarg, 'w', false);
+        break;
+      case 'c':
+        CompactOutputFlag = true;
+        break;
+      case 'a':
+        ArchiveOutputFlag = true;
+        break;
+      case 'z':
+        CompressOutputFlag = true;
+        break;
+      case 'C':
+        CountOnlyFlag = true;
+        break;
+      case 'g':
+        NogoodsFlag = true;
+        break;
+      case 'e':
+        EstimateProbesFlag =
+            parsePositiveArgument(programName, optarg, 'e', false);
+        break;
+      case 'r':
+        CheckpointFileFlag = optarg;
+        break;
+      case 's':
+        SubtreeAddressFlag = optarg;
+        break;
+      case 'S':
+        SplitDepthFlag = parsePositiveArgument(programName, optarg, 'S', false);
+        break;
+      case 'J':
+        StatisticsStreamFlag = optarg;
+        break;
+      case 'p':
+        ProfileFlag = true;
+        break;
+      case 'x':
+        ExpandFileFlag = optarg;
+        break;
       case 'v':
         VerboseModeFlag = true;
         break;
@@ -115,9 +218,61 @@ int realMain0(int argc, char *argv[])
   if (optind != argc) {
     disaster(programName, "Invalid option");
   }
-  if (TargetFolderFlag == NULL) {
+  if (ExpandFileFlag != NULL) {
+    if (hasExtension(ExpandFileFlag, ARCHIVE_EXTENSION)) {
+      archiveExpand(ExpandFileFlag);
+    } else if (hasExtension(ExpandFileFlag, COMPRESS_EXTENSION)) {
+      compressExpand(ExpandFileFlag);
+    } else {
+      compactExpand(ExpandFileFlag, 0);
+    }
+    return 0;
+  }
+  if (TargetFolderFlag == NULL && !CountOnlyFlag &&
+      EstimateProbesFlag == 0) {
     disaster(programName, "Output folder not specified");
   }
+  if (NumberOfThreadsFlag > 1 && NumberOfProcessesFlag > 1) {
+    disaster(programName, "-T and -P cannot be used together");
+  }
+  if (CompactOutputFlag + ArchiveOutputFlag + CompressOutputFlag > 1) {
+    disaster(programName, "Only one of -c, -a and -z can be used");
+  }
+  if (NumberOfWriterThreadsFlag > 0 &&
+      (CompactOutputFlag || ArchiveOutputFlag || CompressOutputFlag)) {
+    disaster(programName, "-w is only for GraphML files, not -c, -a or -z");
+  }
+  if (CountOnlyFlag && (TargetFolderFlag != NULL || CompactOutputFlag ||
+                        ArchiveOutputFlag || CompressOutputFlag ||
+                        NumberOfWriterThreadsFlag > 0)) {
+    disaster(programName,
+             "-C writes no files, so cannot be used with -f, -c, -a, -z or -w");
+  }
+  if (EstimateProbesFlag > 0 &&
+      (CountOnlyFlag || TargetFolderFlag != NULL || NumberOfThreadsFlag > 1 ||
+       NumberOfProcessesFlag > 1)) {
+    disaster(programName, "-e cannot be used with -C, -f, -T or -P");
+  }
+  if (CheckpointFileFlag != NULL &&
+      (NumberOfThreadsFlag > 1 || NumberOfProcessesFlag > 1 ||
+       EstimateProbesFlag > 0)) {
+    disaster(programName, "-r cannot be used with -T, -P or -e");
+  }
+  if ((SubtreeAddressFlag != NULL || SplitDepthFlag > 0) &&
+      (NumberOfThreadsFlag > 1 || NumberOfProcessesFlag > 1 ||
+       EstimateProbesFlag > 0 || CheckpointFileFlag != NULL)) {
+    disaster(programName, "-s and -S cannot be used with -T, -P, -e or -r");
+  }
+  if (SplitDepthFlag > 0 && SubtreeAddressFlag != NULL) {
+    disaster(programName, "-S and -s cannot be used together");
+  }
+  if (SplitDepthFlag > 0 && ProfileFlag) {
+    /* Standard output is just the addresses. */
+    disaster(programName, "-S and -p cannot be used together");
+  }
+  if (SubtreeAddressFlag != NULL && !subtreeSearch(SubtreeAddressFlag)) {
+    disaster(programName, "-s must be an address printed by -S");
+  }
   // Set the appropriate static variables based on whether -d was specified
   if (hasFaceDegrees) {
     PerFaceDegreeMaxSolutionsFlag = localMaxSolutions;
@@ -125,13 +280,74 @@ int realMain0(int argc, char *argv[])
   } else {
     GlobalMaxSolutionsFlag = localMaxSolutions;
     GlobalSkipSolutionsFlag = localSkipSolutions;
+    if ((NumberOfThreadsFlag > 1 || NumberOfProcessesFlag > 1) &&
+        (localMaxSolutions != INT_MAX || localSkipSolutions != 0)) {
+      disaster(programName,
+               "-T or -P can only be used with -m or -k if -d is used");
+    }
   }
 
-  initializeOutputFolder();
-  initializeStatisticLogging("/dev/stdout", 200, 10);
+  if (CountOnlyFlag) {
+    program = NonDeterministicCountProgram;
+    if (SplitDepthFlag == 0) {
+      countPrintHeading();
+    }
+  } else if (EstimateProbesFlag > 0) {
+    program = NonDeterministicEstimateProgram;
+    estimatePrintHeading();
+  } else {
+    initializeOutputFolder();
+  }
+  if (SplitDepthFlag > 0) {
+    /* Standard output is just the addresses. */
+    subtreeSplit(SplitDepthFlag);
+    initializeStatisticLogging(NULL, 200, 10);
+  } else {
+    initializeStatisticLogging("/dev/stdout", 200, 10);
+  }
+  if (StatisticsStreamFlag != NULL) {
+    initializeStatisticStream(StatisticsStreamFlag);
+  }
+  if (CheckpointFileFlag != NULL && checkpointResume(CheckpointFileFlag)) {
+    fprintf(stderr, "Resuming from %s\n", CheckpointFileFlag);
+  }
 
-  engine(NonDeterministicProgram);
+  if (ProfileFlag && NumberOfProcessesFlag == 1) {
+    profileStart();
+  }
+  if (NumberOfProcessesFlag > 1) {
+    /* Each worker starts its own writer threads. */
+    multiprocessRun(NumberOfProcessesFlag);
+  } else {
+    if (NumberOfWriterThreadsFlag > 0) {
+      writerStart(NumberOfWriterThreadsFlag);
+    }
+    if (NumberOfThreadsFlag > 1) {
+      /* The threads share out the calls of the Venn predicate in round
+         SplitRoundFlag, and the solutions of each signature are numbered
+         and logged as without -T. With -g, the nogoods learnt in one task
+         would change the search around the later ones, so the threads
+         take whole signatures. */
+      logShareSignatures(NumberOfThreadsFlag);
+      engineParallel(program, &VennPredicate,
+                     NogoodsFlag ? 0 : SplitRoundFlag, NumberOfThreadsFlag);
+    } else {
+      engine(program);
+    }
+    if (NumberOfWriterThreadsFlag > 0) {
+      writerStop();
+    }
+  }
 
+  if (EstimateProbesFlag > 0) {
+    estimatePrintTotals();
+  }
+  if (CheckpointFileFlag != NULL) {
+    checkpointFinish(CheckpointFileFlag);
+  }
   statisticPrintFull();
+  if (ProfileFlag) {
+    profilePrint();
+  }
   return 0;
 }
@@ -13,6 +13,22 @@
 extern char* TargetFolderFlag; /* Output folder for results (-f) */
 extern bool VerboseModeFlag;   /* Verbose output mode (-v) */
 extern bool TracingFlag;       /* Tracing output mode (-t) */
+extern int NumberOfThreadsFlag; /* Number of search threads (-T) */
+extern int SplitRoundFlag; /* The Venn round shared out by -T (-R) */
+extern int NumberOfProcessesFlag; /* Number of worker processes (-P) */
+extern int NumberOfWriterThreadsFlag; /* Number of GraphML writers (-w) */
+extern bool CompactOutputFlag;    /* Write variations compactly (-c) */
+extern bool ArchiveOutputFlag;    /* Write variations to an archive (-a) */
+extern bool CompressOutputFlag;   /* Write variations compressed (-z) */
+extern char* ExpandFileFlag; /* .var, .gma or .gmz file to expand (-x) */
+extern bool CountOnlyFlag;   /* Only count the variations (-C) */
+extern bool NogoodsFlag;     /* Learn nogoods in the search (-g) */
+extern int EstimateProbesFlag;  /* Estimate the search with probes (-e) */
+extern char* CheckpointFileFlag; /* Checkpoint and resume the search (-r) */
+extern char* SubtreeAddressFlag; /* Only search below this call (-s) */
+extern int SplitDepthFlag;       /* Print the calls at this depth (-S) */
+extern char* StatisticsStreamFlag; /* Stream the statistics as JSON (-J) */
+extern bool ProfileFlag;           /* Profile the search by depth (-p) */
 
 /* Search constraint flags */
 extern FACE_DEGREE
@@ -33,5 +49,7 @@ extern int
 extern int realMain0(int argc, char* argv[]); /* Main program entry */
 extern struct predicate*
     NonDeterministicProgram[]; /* Search algorithm predicates */
+extern struct predicate*
+    NonDeterministicCountProgram[]; /* Counting variations only (-C) */
 
 #endif /* MAIN_H */
@@ -4,56 +4,110 @@
 
 #include "statistics.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
-// Each allocation is wrapped in a header that links to the next allocation
-typedef struct AllocationHeader {
-  struct AllocationHeader *next;
-  void *data;
-} AllocationHeader;
+/*
+ * The temporary allocations are bumped from a chain of chunks. freeAll
+ * just goes back to the start of the first chunk, so the chunks are
+ * reused by the next iteration of the engine; releaseMemory frees them
+ * when the thread is done with them.
+ */
+typedef struct Chunk {
+  struct Chunk *next;
+  size_t size; /* Of data */
+  max_align_t data[];
+} Chunk;
 
-// Global pointer to the start of the allocation chain
-static AllocationHeader *chain = NULL;
+#define CHUNK_SIZE 65536
 #define BUFFER_SIZE 256
+#define ALIGNMENT sizeof(max_align_t)
 
-static uint64 MaxBufferSize = 0;
-static uint64 CurrentMemory = 0;
-static uint64 MaxMemory = 0;
+static THREAD_LOCAL Chunk *FirstChunk = NULL;
+static THREAD_LOCAL Chunk *CurrentChunk = NULL;
+static THREAD_LOCAL size_t CurrentOffset = 0; /* Within CurrentChunk */
+
+static THREAD_LOCAL uint64 MaxBufferSize = 0;
+static THREAD_LOCAL uint64 ChunksInUse = 0;
+static THREAD_LOCAL uint64 MaxChunks = 0;
+static THREAD_LOCAL uint64 CurrentMemory = 0;
+static THREAD_LOCAL uint64 MaxMemory = 0;
 
 void initializeMemory()
 {
-  statisticIncludeInteger(&MaxBufferSize, "B", "MaxBuffer", true);
-  statisticIncludeInteger(&CurrentMemory, "C", "CurrentMemory", true);
-  statisticIncludeInteger(&MaxMemory, "M", "MaxMemory", true);
+  statisticIncludeMaximum(&MaxBufferSize, "B", "MaxBuffer", true);
+  statisticIncludeMaximum(&MaxChunks, "C", "MaxChunks", true);
+  statisticIncludeMaximum(&MaxMemory, "M", "MaxMemory", true);
 }
 
 void freeAll(void)
 {
-  while (chain) {
-    AllocationHeader *next = chain->next;
-    free(chain);
-    chain = next;
-  }
+  CurrentChunk = FirstChunk;
+  CurrentOffset = 0;
+  ChunksInUse = FirstChunk == NULL ? 0 : 1;
   CurrentMemory = 0;
 }
 
-void *tempMalloc(size_t size)
+void releaseMemory(void)
 {
-  // Allocate header + requested size
-  AllocationHeader *header = malloc(sizeof(AllocationHeader) + size);
-  if (!header) return NULL;
+  while (FirstChunk != NULL) {
+    Chunk *next = FirstChunk->next;
+    free(FirstChunk);
+    FirstChunk = next;
+  }
+  freeAll();
+}
 
-  // Set up the header
-  header->next = chain;
-  header->data = (void *)(header + 1);  // Vertex to the data area
+static Chunk *newChunk(size_t size, Chunk *next)
+{
+  Chunk *result;
+  if (size < CHUNK_SIZE) {
+    size = CHUNK_SIZE;
+  }
+  result = malloc(sizeof(Chunk) + size);
+  if (result == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  result->next = next;
+  result->size = size;
+  return result;
+}
 
-  // Update chain
-  chain = header;
-  CurrentMemory += size + sizeof(AllocationHeader);
+/* Moves on to a chunk, after the current one, with room for size bytes. */
+static void nextChunk(size_t size)
+{
+  Chunk *next = CurrentChunk == NULL ? FirstChunk : CurrentChunk->next;
+  if (next == NULL || next->size < size) {
+    next = newChunk(size, next);
+    if (CurrentChunk == NULL) {
+      FirstChunk = next;
+    } else {
+      CurrentChunk->next = next;
+    }
+  }
+  CurrentChunk = next;
+  CurrentOffset = 0;
+  ChunksInUse++;
+  if (ChunksInUse > MaxChunks) {
+    MaxChunks = ChunksInUse;
+  }
+}
+
+void *tempMalloc(size_t size)
+{
+  void *result;
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  if (CurrentChunk == NULL || CurrentOffset + size > CurrentChunk->size) {
+    nextChunk(size);
+  }
+  result = (char *)CurrentChunk->data + CurrentOffset;
+  CurrentOffset += size;
+  CurrentMemory += size;
   if (CurrentMemory > MaxMemory) {
     MaxMemory = CurrentMemory;
   }
-  return header->data;
+  return result;
 }
 
 char *getBuffer()
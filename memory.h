@@ -15,6 +15,7 @@
 extern void initializeMemory(void);   /* Initialize memory system */
 extern void *tempMalloc(size_t size); /* Allocate temporary memory */
 extern void freeAll(void);            /* Free all temporary allocations */
+extern void releaseMemory(void);      /* Free the chunks, as a thread ends */
 
 /* String buffer functions */
 extern char *getBuffer(void);           /* Get a temporary string buffer */
@@ -0,0 +1,328 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "multiprocess.h"
+
+#include "face.h"
+#include "main.h"
+#include "predicates.h"
+#include "profile.h"
+#include "statistics.h"
+#include "utils.h"
+#include "visible_for_testing.h"
+#include "writer.h"
+
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * The parent writes each task, a face degree signature, as a line on the
+ * task pipe of a worker. The worker searches that signature, with its
+ * standard output going back to the parent, and then writes DONE_LINE.
+ * When the parent closes the task pipe, the worker writes its statistics,
+ * see statisticWriteTotals, and exits. The parent copies every other line
+ * to its own standard output, so that lines of different workers are not
+ * mixed up.
+ */
+#define DONE_LINE "#done\n"
+#define MAX_LINE 4096
+
+struct worker {
+  pid_t pid;
+  int taskFd;   /* -1 when there are no more tasks */
+  int outputFd; /* -1 at end of file */
+  char line[MAX_LINE];
+  size_t lineLength;
+};
+
+static FACE_DEGREE Signatures[MAX_SIGNATURES][NCOLORS];
+static int SignatureMilliseconds[MAX_SIGNATURES];
+static double SignatureCosts[MAX_SIGNATURES];
+static int SignatureOrder[MAX_SIGNATURES];
+static int NumberOfSignatures = 0;
+static int NextSignature = 0;
+
+#if NCOLORS == 6
+/*
+ * How long, in milliseconds, bin/venn -C -d took to search each signature,
+ * less the time to start up, on one core, averaged over two runs. Every
+ * other signature took no measurable time. The size of the search space
+ * does not track these: 644544 has one of the largest, but is searched in
+ * a seventh of the time of 555444. If the search changes, only the order in
+ * which the signatures are handed out is affected.
+ */
+static const struct {
+  const char* signature;
+  int milliseconds;
+} MeasuredCosts[] = {
+    {"555444", 1578}, {"555543", 1421}, {"545454", 1303}, {"655434", 1070},
+    {"554544", 946}, {"654435", 920}, {"555453", 838}, {"554553", 732},
+    {"654345", 706}, {"654444", 691}, {"645444", 677}, {"655335", 609},
+    {"665334", 600}, {"665433", 555}, {"644553", 483}, {"655533", 476},
+    {"655443", 426}, {"655344", 424}, {"664434", 370}, {"654543", 365},
+    {"654354", 347}, {"664443", 338}, {"654453", 329}, {"645534", 315},
+    {"653454", 313}, {"654534", 311}, {"653544", 308}, {"645543", 289},
+    {"644544", 232}, {"656433", 140},
+};
+#endif
+
+/* The measured time of the signature, or 0 if it was not measured. */
+static int measuredCost(FACE_DEGREE* degrees)
+{
+#if NCOLORS == 6
+  for (size_t i = 0; i < sizeof(MeasuredCosts) / sizeof(MeasuredCosts[0]);
+       i++) {
+    int j;
+    for (j = 0; j < NCOLORS; j++) {
+      if ((FACE_DEGREE)(MeasuredCosts[i].signature[j] - '0') != degrees[j]) {
+        break;
+      }
+    }
+    if (j == NCOLORS) {
+      return MeasuredCosts[i].milliseconds;
+    }
+  }
+#else
+  (void)degrees;
+#endif
+  return 0;
+}
+
+/*
+ * The log of the size of the search space that is left after setting up
+ * the central face. This is a cheap guide to the relative cost of searching
+ * the signatures that have not been measured.
+ */
+static double estimateSearchCost(FACE_DEGREE* degrees)
+{
+  TRAIL trail = trailBacktrackPoint();
+  double result = 0.0;
+  dynamicFaceSetupCentral(degrees);
+  for (uint32_t i = 0; i < NFACES; i++) {
+    if (Context.faces[i].cycle == NULL && Context.faces[i].cycleSetSize > 0) {
+      result += log(Context.faces[i].cycleSetSize);
+    }
+  }
+  trailRewindTo(trail);
+  return result;
+}
+
+/* The measured signatures go first, slowest first, then the others. */
+static int compareCosts(const void* a, const void* b)
+{
+  int i = *(const int*)a, j = *(const int*)b;
+  if (SignatureMilliseconds[i] != SignatureMilliseconds[j]) {
+    return SignatureMilliseconds[j] - SignatureMilliseconds[i];
+  }
+  if (SignatureCosts[i] != SignatureCosts[j]) {
+    return SignatureCosts[i] > SignatureCosts[j] ? -1 : 1;
+  }
+  return i - j;
+}
+
+/*
+ * This is a thread of its own, so that it does not change the counters of
+ * the parent, which the workers inherit.
+ */
+static void* initializeSignaturesThread(void* unused)
+{
+  (void)unused;
+  initialize();
+  NumberOfSignatures = innerFaceSignatures(Signatures);
+  for (int i = 0; i < NumberOfSignatures; i++) {
+    SignatureMilliseconds[i] = measuredCost(Signatures[i]);
+    SignatureCosts[i] = estimateSearchCost(Signatures[i]);
+    SignatureOrder[i] = i;
+  }
+  releaseMemory();
+  return NULL;
+}
+
+static void initializeSignatures(void)
+{
+  pthread_t thread;
+  initialize();
+  if (pthread_create(&thread, NULL, initializeSignaturesThread, NULL) != 0) {
+    perror("pthread_create");
+    exit(EXIT_FAILURE);
+  }
+  pthread_join(thread, NULL);
+  qsort(SignatureOrder, NumberOfSignatures, sizeof(int), compareCosts);
+  NextSignature = 0;
+}
+
+static void workerMain(FILE* tasks)
+{
+  char line[NCOLORS + 2];
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  /* The parent reports its own counters, e.g. from initialization. */
+  statisticResetCounters();
+  if (ProfileFlag) {
+    /* The timer of the parent is not inherited. */
+    profileStart();
+  }
+  if (NumberOfWriterThreadsFlag > 0) {
+    writerStart(NumberOfWriterThreadsFlag);
+  }
+  while (fgets(line, sizeof(line), tasks) != NULL) {
+    for (int i = 0; i < NCOLORS; i++) {
+      CentralFaceDegreesFlag[i] = line[i] - '0';
+    }
+    engine(CountOnlyFlag ? NonDeterministicCountProgram
+                         : NonDeterministicProgram);
+    fputs(DONE_LINE, stdout);
+  }
+  if (NumberOfWriterThreadsFlag > 0) {
+    writerStop();
+  }
+  statisticWriteTotals(stdout);
+  fflush(stdout);
+}
+
+static void startWorker(struct worker* workers, int index)
+{
+  struct worker* worker = &workers[index];
+  int taskPipe[2], outputPipe[2];
+  if (pipe(taskPipe) != 0 || pipe(outputPipe) != 0) {
+    perror("pipe");
+    exit(EXIT_FAILURE);
+  }
+  fflush(NULL);
+  worker->pid = fork();
+  if (worker->pid < 0) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+  if (worker->pid == 0) {
+    /* Otherwise the other workers would not see the end of their tasks. */
+    for (int i = 0; i < index; i++) {
+      if (workers[i].taskFd >= 0) {
+        close(workers[i].taskFd);
+      }
+      if (workers[i].outputFd >= 0) {
+        close(workers[i].outputFd);
+      }
+    }
+    close(taskPipe[1]);
+    close(outputPipe[0]);
+    if (dup2(outputPipe[1], STDOUT_FILENO) < 0) {
+      perror("dup2");
+      _exit(EXIT_FAILURE);
+    }
+    close(outputPipe[1]);
+    workerMain(fdopen(taskPipe[0], "r"));
+    _exit(EXIT_SUCCESS);
+  }
+  close(taskPipe[0]);
+  close(outputPipe[1]);
+  worker->taskFd = taskPipe[1];
+  worker->outputFd = outputPipe[0];
+  worker->lineLength = 0;
+}
+
+/* Gives the worker its next task, or tells it that there are no more. */
+static void nextTask(struct worker* worker)
+{
+  if (NextSignature == NumberOfSignatures) {
+    close(worker->taskFd);
+    worker->taskFd = -1;
+    return;
+  }
+  char line[NCOLORS + 2];
+  FACE_DEGREE* degrees = Signatures[SignatureOrder[NextSignature++]];
+  for (int i = 0; i < NCOLORS; i++) {
+    line[i] = '0' + degrees[i];
+  }
+  line[NCOLORS] = '\n';
+  if (write(worker->taskFd, line, NCOLORS + 1) != NCOLORS + 1) {
+    perror("write");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void handleLine(struct worker* worker, char* line)
+{
+  if (strcmp(line, DONE_LINE) == 0) {
+    nextTask(worker);
+  } else if (!statisticReadTotal(line)) {
+    fputs(line, stdout);
+  }
+}
+
+/* Reads what is available from the worker, handling each complete line. */
+static void readFromWorker(struct worker* worker)
+{
+  ssize_t length = read(worker->outputFd, worker->line + worker->lineLength,
+                        MAX_LINE - 1 - worker->lineLength);
+  if (length <= 0) {
+    close(worker->outputFd);
+    worker->outputFd = -1;
+    return;
+  }
+  char* start = worker->line;
+  char* end = worker->line + worker->lineLength + length;
+  char* newline;
+  while ((newline = memchr(start, '\n', end - start)) != NULL) {
+    char saved = newline[1];
+    newline[1] = '\0';
+    handleLine(worker, start);
+    newline[1] = saved;
+    start = newline + 1;
+  }
+  worker->lineLength = end - start;
+  memmove(worker->line, start, worker->lineLength);
+  if (worker->lineLength == MAX_LINE - 1) {
+    /* Too long for one line: pass it on in pieces. */
+    worker->line[worker->lineLength] = '\0';
+    fputs(worker->line, stdout);
+    worker->lineLength = 0;
+  }
+}
+
+void multiprocessRun(int numberOfProcesses)
+{
+  initializeSignatures();
+  if (numberOfProcesses > NumberOfSignatures) {
+    numberOfProcesses = NumberOfSignatures;
+  }
+  struct worker workers[numberOfProcesses];
+  struct pollfd fds[numberOfProcesses];
+  for (int i = 0; i < numberOfProcesses; i++) {
+    startWorker(workers, i);
+    nextTask(&workers[i]);
+  }
+  for (int running = numberOfProcesses; running > 0;) {
+    for (int i = 0; i < numberOfProcesses; i++) {
+      fds[i].fd = workers[i].outputFd;
+      fds[i].events = POLLIN;
+    }
+    if (poll(fds, numberOfProcesses, -1) < 0) {
+      perror("poll");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numberOfProcesses; i++) {
+      if (fds[i].revents != 0) {
+        readFromWorker(&workers[i]);
+        if (workers[i].outputFd < 0) {
+          running--;
+        }
+      }
+    }
+  }
+  for (int i = 0; i < numberOfProcesses; i++) {
+    int status;
+    if (workers[i].taskFd >= 0) {
+      close(workers[i].taskFd);
+    }
+    if (waitpid(workers[i].pid, &status, 0) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != EXIT_SUCCESS) {
+      fprintf(stderr, "Worker process %d failed\n", (int)workers[i].pid);
+      exit(EXIT_FAILURE);
+    }
+  }
+  statisticAddThreadTotals();
+}
@@ -0,0 +1,14 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef MULTIPROCESS_H
+#define MULTIPROCESS_H
+
+/**
+ * Runs the search in numberOfProcesses forked worker processes (-P).
+ * Each worker searches whole face degree signatures, as if with -d.
+ * The parent hands out the signatures, the most expensive first, and
+ * merges the output and the statistics of the workers.
+ */
+extern void multiprocessRun(int numberOfProcesses);
+
+#endif /* MULTIPROCESS_H */
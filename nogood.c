@@ -0,0 +1,261 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "nogood.h"
+
+#include "common.h"
+#include "statistics.h"
+#include "visible_for_testing.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+THREAD_LOCAL uint64 NogoodHitCounter = 0;
+THREAD_LOCAL uint64 NogoodLearnedCounter = 0;
+THREAD_LOCAL uint64 NogoodReplayCounter = 0;
+
+/* A power of two. */
+#define NOGOOD_TABLE_SIZE (1 << 16)
+/* How many times the choices of a candidate must fail together before it
+ * is replayed. */
+#define REPLAY_FAILURES 4
+
+/*
+ * The table holds the nogoods with two pairs, and the candidates for them.
+ * A candidate is SEEN when its choices first fail together in the search,
+ * and only replayed when they have failed together REPLAY_FAILURES times:
+ * most candidates are not nogoods, and each replay, which copies the whole
+ * search context, costs more than the guesses that a nogood saves, unless
+ * its choices keep coming up. The table is direct mapped, and a new entry
+ * replaces whatever was in its slot, so the pairs are compared, not just
+ * the keys.
+ *
+ * The nogoods with one pair are simpler: each choice is replayed alone
+ * the first time it fails, see Tested, and Failing holds the results.
+ *
+ * Since a slot of the table may be reused, the nogoods that are found are
+ * also indexed by each of their two pairs, in links: heads[face][cycle] is
+ * the first link for that pair, which names the other pair of the nogood.
+ * So checking a choice looks only at the nogoods that mention it, rather
+ * than at the current cycle of every face. When the links run out, no more
+ * nogoods are indexed.
+ */
+enum nogoodState { EMPTY, SEEN, FAILS, SUCCEEDS };
+
+struct nogood {
+  uint64 key;
+  uint8_t state; /* enum nogoodState */
+  uint8_t failures; /* while SEEN */
+  uint8_t faces[2];
+  uint16_t cycles[2];
+};
+
+#define NOGOOD_LINKS NOGOOD_TABLE_SIZE
+
+struct nogoodLink {
+  int32_t next; /* -1 at the end */
+  uint8_t face;
+  uint16_t cycle;
+};
+
+/* The large tables, over 1MB, are only allocated by the threads that
+ * search with -g, and freed as such a thread ends, see TablesKey. */
+struct nogoodTables {
+  struct nogood nogoods[NOGOOD_TABLE_SIZE];
+  int32_t heads[NFACES][NCYCLES];
+  struct nogoodLink links[NOGOOD_LINKS];
+  int32_t numberOfLinks;
+  struct searchContext startContext;
+  struct searchContext savedContext;
+};
+
+static THREAD_LOCAL struct nogoodTables* Tables = NULL;
+static THREAD_LOCAL CYCLESET_DECLARE Tested[NFACES];
+static THREAD_LOCAL CYCLESET_DECLARE Failing[NFACES];
+static pthread_key_t TablesKey;
+static pthread_once_t TablesKeyOnce = PTHREAD_ONCE_INIT;
+
+void initializeNogoods(void)
+{
+  statisticIncludeInteger(&NogoodHitCounter, "!", "nogood hits", false);
+  statisticIncludeInteger(&NogoodLearnedCounter, "&", "nogoods", true);
+  statisticIncludeInteger(&NogoodReplayCounter, "R", "nogood replays", true);
+}
+
+static void createTablesKey(void)
+{
+  if (pthread_key_create(&TablesKey, free) != 0) {
+    perror("pthread_key_create");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void nogoodStartSearch(void)
+{
+  if (Tables == NULL) {
+    pthread_once(&TablesKeyOnce, createTablesKey);
+    Tables = malloc(sizeof(*Tables));
+    if (Tables == NULL) {
+      perror("malloc");
+      exit(EXIT_FAILURE);
+    }
+    pthread_setspecific(TablesKey, Tables);
+  }
+  memset(Tables->nogoods, 0, sizeof(Tables->nogoods));
+  memset(Tables->heads, -1, sizeof(Tables->heads));
+  Tables->numberOfLinks = 0;
+  memset(Tested, 0, sizeof(Tested));
+  memset(Failing, 0, sizeof(Failing));
+  contextClone(&Tables->startContext);
+}
+
+static uint64 keyOf(FACE face, CYCLE cycle)
+{
+  return ZobristKeys[face->colors][cycle - Cycles];
+}
+
+static struct nogood* lookup(uint64 key, FACE* faces, CYCLE* cycles)
+{
+  struct nogood* entry = &Tables->nogoods[key & (NOGOOD_TABLE_SIZE - 1)];
+  uint32_t i, j;
+  if (entry->key != key || entry->state == EMPTY) {
+    return NULL;
+  }
+  /* The pairs may be in either order. */
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < 2; j++) {
+      if (entry->faces[j] == faces[i]->colors &&
+          entry->cycles[j] == cycles[i] - Cycles) {
+        break;
+      }
+    }
+    if (j == 2) {
+      return NULL;
+    }
+  }
+  return entry;
+}
+
+static void store(uint64 key, FACE* faces, CYCLE* cycles,
+                  enum nogoodState state)
+{
+  struct nogood* entry = &Tables->nogoods[key & (NOGOOD_TABLE_SIZE - 1)];
+  entry->key = key;
+  entry->state = state;
+  entry->failures = 1;
+  for (uint32_t i = 0; i < 2; i++) {
+    entry->faces[i] = faces[i]->colors;
+    entry->cycles[i] = cycles[i] - Cycles;
+  }
+}
+
+/* Indexes the nogood under the first pair, naming the second. */
+static void addLink(FACE* faces, CYCLE* cycles)
+{
+  int32_t* head = &Tables->heads[faces[0]->colors][cycles[0] - Cycles];
+  struct nogoodLink* link = &Tables->links[Tables->numberOfLinks];
+  link->next = *head;
+  link->face = faces[1]->colors;
+  link->cycle = cycles[1] - Cycles;
+  *head = Tables->numberOfLinks++;
+}
+
+static void indexNogood(FACE* faces, CYCLE* cycles)
+{
+  FACE reversedFaces[2] = {faces[1], faces[0]};
+  CYCLE reversedCycles[2] = {cycles[1], cycles[0]};
+  if (Tables->numberOfLinks + 2 > NOGOOD_LINKS) {
+    return;
+  }
+  addLink(faces, cycles);
+  addLink(reversedFaces, reversedCycles);
+}
+
+bool nogoodViolated(FACE face, CYCLE cycle)
+{
+  struct nogoodLink* link;
+  int32_t i;
+  if (cycleSetMember(cycle - Cycles, Failing[face->colors])) {
+    NogoodHitCounter++;
+    return true;
+  }
+  for (i = Tables->heads[face->colors][cycle - Cycles]; i >= 0;
+       i = link->next) {
+    link = &Tables->links[i];
+    if (FACE_STATE(Faces + link->face)->cycle == Cycles + link->cycle) {
+      NogoodHitCounter++;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Whether the cycles fail together, from the start of the search. The
+ * replay must not show in the statistics, and the current state is put
+ * back afterwards.
+ */
+static bool replayFails(uint8_t size, FACE* faces, CYCLE* cycles)
+{
+  TRAIL trail = trailBacktrackPoint();
+  uint64 guesses = CycleGuessCounterIPC;
+  uint64 forced = CycleForcedCounter;
+  uint64 reduced = CycleSetReducedCounter;
+  bool fails = false;
+  contextClone(&Tables->savedContext);
+  contextRestore(&Tables->startContext);
+  FailureCountingSuspended++;
+  for (uint32_t i = 0; i < size && !fails; i++) {
+    struct faceState* state = FACE_STATE(faces[i]);
+    if (state->cycle != NULL) {
+      fails = state->cycle != cycles[i];
+    } else if (!cycleSetMember(cycles[i] - Cycles, state->possibleCycles)) {
+      fails = true;
+    } else {
+      state->cycle = cycles[i];
+      fails = dynamicFaceBacktrackableChoice(faces[i]) != NULL;
+    }
+  }
+  FailureCountingSuspended--;
+  trailRewindTo(trail);
+  contextRestore(&Tables->savedContext);
+  CycleGuessCounterIPC = guesses;
+  CycleForcedCounter = forced;
+  CycleSetReducedCounter = reduced;
+  return fails;
+}
+
+static void learnPair(FACE* faces, CYCLE* cycles)
+{
+  uint64 key = keyOf(faces[0], cycles[0]) ^ keyOf(faces[1], cycles[1]);
+  struct nogood* entry = lookup(key, faces, cycles);
+  if (entry == NULL) {
+    store(key, faces, cycles, SEEN);
+  } else if (entry->state == SEEN &&
+             ++entry->failures == REPLAY_FAILURES) {
+    NogoodReplayCounter++;
+    entry->state = replayFails(2, faces, cycles) ? FAILS : SUCCEEDS;
+    if (entry->state == FAILS) {
+      NogoodLearnedCounter++;
+      indexNogood(faces, cycles);
+    }
+  }
+}
+
+void nogoodLearn(FACE face, CYCLE cycle, FACE previousChoice)
+{
+  FACE faces[2] = {previousChoice, face};
+  CYCLE cycles[2] = {NULL, cycle};
+  if (!cycleSetMember(cycle - Cycles, Tested[face->colors])) {
+    cycleSetAdd(cycle - Cycles, Tested[face->colors]);
+    NogoodReplayCounter++;
+    if (replayFails(1, faces + 1, cycles + 1)) {
+      cycleSetAdd(cycle - Cycles, Failing[face->colors]);
+      NogoodLearnedCounter++;
+      return;
+    }
+  }
+  if (previousChoice != NULL) {
+    cycles[0] = FACE_STATE(previousChoice)->cycle;
+    learnPair(faces, cycles);
+  }
+}
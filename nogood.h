@@ -0,0 +1,37 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef NOGOOD_H
+#define NOGOOD_H
+
+#include "face.h"
+
+/**
+ * Nogood learning for the Venn search (-g). A nogood is a set of one or
+ * two facial cycles, (face, cycle) pairs, that cannot all hold, given the
+ * central face degrees of the current search. When the choice of a cycle
+ * fails, we look for such a set containing it, by replaying it, alone and
+ * with the previous choice, from the start of the search. The nogoods of
+ * two pairs are kept in a bounded hash table, keyed by the XOR of a zobrist
+ * key for each pair, and indexed by each pair. Before propagating a choice,
+ * we check whether it completes a nogood with the cycles already known.
+ */
+
+extern THREAD_LOCAL uint64 NogoodHitCounter;
+extern THREAD_LOCAL uint64 NogoodLearnedCounter;
+extern THREAD_LOCAL uint64 NogoodReplayCounter;
+
+extern void initializeNogoods(void);
+
+/* Forgets the nogoods, and records the current state as the start of a
+ * new search: that is, after the central face degrees are set up. */
+extern void nogoodStartSearch(void);
+
+/* Whether choosing cycle for face, in the current state, would complete a
+ * nogood. */
+extern bool nogoodViolated(FACE face, CYCLE cycle);
+
+/* Called after choosing cycle for face has failed. previousChoice is the
+ * face chosen before, or NULL. */
+extern void nogoodLearn(FACE face, CYCLE cycle, FACE previousChoice);
+
+#endif  // NOGOOD_H
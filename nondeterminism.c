@@ -25,3 +25,18 @@ struct predicate* NonDeterministicProgram[] = {
     &InitializePredicate, &InnerFacePredicate, &LogPredicate,
     &VennPredicate,       &SavePredicate,      &CornersPredicate,
     &GraphMLPredicate,    &FAILPredicate};
+
+/**
+ * With -C, instead of saving each solution and its variations, Count prints
+ * the number of variations of each solution, and fails.
+ */
+struct predicate* NonDeterministicCountProgram[] = {
+    &InitializePredicate, &InnerFacePredicate, &LogPredicate, &VennPredicate,
+    &CountPredicate};
+
+/**
+ * With -e, instead of searching each face degree signature, Estimate
+ * prints an estimate of the size of its search, and fails.
+ */
+struct predicate* NonDeterministicEstimateProgram[] = {
+    &InitializePredicate, &InnerFacePredicate, &EstimatePredicate};
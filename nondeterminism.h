@@ -17,4 +17,10 @@
  */
 extern struct predicate* NonDeterministicProgram[];
 
+/* The program that only counts the variations of each solution (-C). */
+extern struct predicate* NonDeterministicCountProgram[];
+
+/* The program that estimates the size of each search (-e). */
+extern struct predicate* NonDeterministicEstimateProgram[];
+
 #endif /* NONDETERMINISM_H */
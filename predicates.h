@@ -17,10 +17,33 @@ extern struct predicate InitializePredicate;
 extern struct predicate InnerFacePredicate;  /* Select face degrees */
 extern struct predicate VennPredicate;       /* Assign cycles to faces */
 
+/* The face degree signatures tried by InnerFacePredicate, see innerface.c */
+#define MAX_SIGNATURES 4096
+extern int innerFaceSignatures(FACE_DEGREE (*signatures)[NCOLORS]);
+
 /* Output phases - save and display results */
 extern struct predicate LogPredicate;        /* Log progress */
 extern struct predicate SavePredicate;       /* Save solutions */
 extern struct predicate CornersPredicate;    /* Place diagram corners */
 extern struct predicate GraphMLPredicate;    /* Export to GraphML format */
+extern struct predicate CountPredicate;      /* Count variations (-C) */
+extern struct predicate EstimatePredicate;   /* Estimate the search (-e) */
+
+/*
+ * Before engineParallel, makes its search threads log each face degree
+ * signature once, with what they all found; then, after
+ * engineWaitForEarlierTasks, logNumberSolution numbers the solutions of
+ * the signature as without the threads.
+ */
+extern void logShareSignatures(int numberOfThreads);
+extern int logNumberSolution(void);
+
+/* Prints the heading of the table printed by CountPredicate */
+extern void countPrintHeading(void);
+
+/* Print the heading and the last row of the table printed by
+ * EstimatePredicate, see estimate.c */
+extern void estimatePrintHeading(void);
+extern void estimatePrintTotals(void);
 
 #endif  /* PREDICATES_H */
\ No newline at end of file
@@ -0,0 +1,152 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "profile.h"
+
+#include "engine.h"
+#include "failure.h"
+#include "predicates.h"
+#include "statistics.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+/* The CPU time between samples: not less than a clock tick, since the
+ * timer only fires at a tick. */
+#define SAMPLE_MICROSECONDS 10000
+
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+
+/* Depths beyond the last are counted in the last. */
+static THREAD_LOCAL Failure SamplesByDepth = {
+    .shortLabel = "sd",
+    .label = "Samples by depth",
+    .count = {0},
+};
+
+static THREAD_LOCAL Failure SamplesByRound = {
+    .shortLabel = "sr",
+    .label = "Samples by round",
+    .count = {0},
+};
+
+static THREAD_LOCAL Failure NodesByRound = {
+    .shortLabel = "nr",
+    .label = "Nodes by round",
+    .count = {0},
+};
+
+/* The sum of the branching factors, to give their mean. */
+static THREAD_LOCAL Failure ChoicesByRound = {
+    .shortLabel = "cr",
+    .label = "Choices by round",
+    .count = {0},
+};
+
+void initializeProfile(void)
+{
+  statisticIncludeFailure(&SamplesByDepth);
+  statisticIncludeFailure(&SamplesByRound);
+  statisticIncludeFailure(&NodesByRound);
+  statisticIncludeFailure(&ChoicesByRound);
+}
+
+/* The SIGPROF handler, in whichever thread was running. */
+static void sample(int signal)
+{
+  int depth;
+  struct stackEntry* top = engineTop(&depth);
+  (void)signal;
+  if (top == NULL) {
+    return;
+  }
+  SamplesByDepth.count[depth < NFACES ? depth : NFACES - 1]++;
+  if (top->predicate == &VennPredicate) {
+    SamplesByRound.count[top->round]++;
+  }
+}
+
+static void setTimer(int microseconds)
+{
+  struct itimerval timer = {{0, microseconds}, {0, microseconds}};
+  if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+    perror("setitimer");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void profileStart(void)
+{
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = sample;
+  /* So that e.g. reading the tasks of a worker is not interrupted. */
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, NULL) != 0) {
+    perror("sigaction");
+    exit(EXIT_FAILURE);
+  }
+  setTimer(SAMPLE_MICROSECONDS);
+}
+
+void profileNode(int round, uint64 choices)
+{
+  NodesByRound.count[round]++;
+  ChoicesByRound.count[round] += choices;
+}
+
+static double seconds(uint64 samples)
+{
+  return samples * (SAMPLE_MICROSECONDS / 1e6);
+}
+
+static double percentage(uint64 samples, uint64 total)
+{
+  return total == 0 ? 0.0 : 100.0 * samples / total;
+}
+
+/* Prints the time and the nodes of each round of the Venn predicate, and
+ * the time at each depth of the stack, as a percentage of all the time
+ * sampled. */
+void profilePrint(void)
+{
+  FAILURE samplesByDepth = statisticFindFailure(SamplesByDepth.label);
+  FAILURE samplesByRound = statisticFindFailure(SamplesByRound.label);
+  FAILURE nodesByRound = statisticFindFailure(NodesByRound.label);
+  FAILURE choicesByRound = statisticFindFailure(ChoicesByRound.label);
+  uint64 total = 0;
+  setTimer(0);
+  if (samplesByDepth == NULL || samplesByRound == NULL ||
+      nodesByRound == NULL || choicesByRound == NULL) {
+    return;
+  }
+  for (int i = 0; i < NFACES; i++) {
+    total += samplesByDepth->count[i];
+  }
+  printf("\nRound | Nodes | Mean choices | Seconds | Time\n");
+  printf("--- | --- | --- | --- | ---\n");
+  for (int i = 0; i < NFACES; i++) {
+    if (nodesByRound->count[i] == 0 && samplesByRound->count[i] == 0) {
+      continue;
+    }
+    printf("%d | %llu | %.2f | %.3f | %.1f%%\n", i, nodesByRound->count[i],
+           nodesByRound->count[i] == 0
+               ? 0.0
+               : (double)choicesByRound->count[i] / nodesByRound->count[i],
+           seconds(samplesByRound->count[i]),
+           percentage(samplesByRound->count[i], total));
+  }
+  printf("\nDepth | Seconds | Time\n");
+  printf("--- | --- | ---\n");
+  for (int i = 0; i < NFACES; i++) {
+    if (samplesByDepth->count[i] == 0) {
+      continue;
+    }
+    printf("%d%s | %.3f | %.1f%%\n", i, i == NFACES - 1 ? "+" : "",
+           seconds(samplesByDepth->count[i]),
+           percentage(samplesByDepth->count[i], total));
+  }
+  printf("Total | %.3f | 100%%\n", seconds(total));
+}
@@ -0,0 +1,31 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "core.h"
+
+/**
+ * Profiling the search by depth (-p). A profiling timer samples the engine
+ * stack every 10 milliseconds of CPU time, counting the samples at each depth
+ * of the stack, and, while the Venn predicate is running, at each of its
+ * rounds. The Venn predicate also counts its calls at each round, and the
+ * number of possible cycles of each face chosen, i.e. the branching factor.
+ * These histograms are kept like the failures, see failure.c, so they are
+ * added up over threads and processes, and written with -J; at the end,
+ * profilePrint shows where the time went, by round and by depth.
+ */
+
+/* Includes the histograms of this thread in the statistics. */
+extern void initializeProfile(void);
+
+/* Starts sampling this process. */
+extern void profileStart(void);
+
+/* Called by the Venn predicate, when it chooses a face with choices
+ * possible cycles in round. */
+extern void profileNode(int round, uint64 choices);
+
+extern void profilePrint(void);
+
+#endif  // PROFILE_H
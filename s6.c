@@ -42,20 +42,45 @@ static int dihedralGroup[2 * NCOLORS][NCOLORS] = {
     {0, 1, 2, 3, 4}, {1, 2, 3, 4, 0}, {2, 3, 4, 0, 1}, {3, 4, 0, 1, 2},
     {4, 0, 1, 2, 3}, {4, 3, 2, 1, 0}, {3, 2, 1, 0, 4}, {2, 1, 0, 4, 3},
     {1, 0, 4, 3, 2}, {0, 4, 3, 2, 1}
+#elif NCOLORS == 3
+    {0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}, {1, 0, 2}, {0, 2, 1}
 #endif
 };
 
-/* Comparison function for signatures, used for sorting */
-static int s6SignatureCompare(const void *a, const void *b)
-{
-  return memcmp(a, b, sizeof(((CYCLE_ID_SEQUENCE)NULL)[0]));
-}
+/* The number of cycles of length NCOLORS, which are the last cycles. */
+#if NCOLORS == 6
+#define NAUTOMORPHISMS FACTORIAL5
+#elif NCOLORS == 5
+#define NAUTOMORPHISMS FACTORIAL4
+#elif NCOLORS == 4
+#define NAUTOMORPHISMS FACTORIAL3
+#else
+#define NAUTOMORPHISMS FACTORIAL2
+#endif
 
-/* Comparison function for cycle ID sequences, used for sorting */
-static int compareCycleIdSequence(const void *a, const void *b)
-{
-  return -s6SignatureCompare(*(SIGNATURE *)a, *(SIGNATURE *)b);
-}
+/* The image of each face and of each cycle under a permutation. */
+struct permutationTable {
+  COLORSET colorSet[NFACES];
+  COLORSET inverseColorSet[NFACES];
+  CYCLE_ID cycleId[NCYCLES];
+};
+
+/* For each element of dihedralGroup, and for the automorphism of each cycle
+ * of length NCOLORS, see s6Automorphism. */
+static MEMO struct permutationTable DihedralTables[2 * NCOLORS];
+static MEMO struct permutationTable AutomorphismTables[NAUTOMORPHISMS];
+
+/* The mirror image of each cycle, see cycleIdReverseDirection. */
+static MEMO CYCLE_ID ReversedCycleIds[NCYCLES];
+
+/*
+ * The faces without one color, and then those without two adjacent colors,
+ * start SequenceOrder. The dihedral group permutes these faces among
+ * themselves: for each element, the position in SequenceOrder of the face
+ * that it maps to each of these positions.
+ */
+#define PREFIX_LENGTH (2 * NCOLORS)
+static MEMO int PrefixPermutations[2 * NCOLORS][PREFIX_LENGTH];
 
 /* Comparison function for face degree sequences, used for sorting */
 static int compareFaceDegree(const void *a, const void *b)
@@ -137,11 +162,52 @@ CYCLE_ID s6PermuteCycleId(CYCLE_ID originalCycleId, PERMUTATION permutation)
   return getCycleId(permuted + minIndex, cycle->length);
 }
 
+static void initializePermutationTable(struct permutationTable *table,
+                                       PERMUTATION permutation)
+{
+  for (COLORSET i = 0; i < NFACES; i++) {
+    table->colorSet[i] = colorSetPermute(i, permutation);
+    table->inverseColorSet[table->colorSet[i]] = i;
+  }
+  for (CYCLE_ID i = 0; i < NCYCLES; i++) {
+    table->cycleId[i] = s6PermuteCycleId(i, permutation);
+  }
+}
+
+static void initializePermutationTables(void)
+{
+  for (int i = 0; i < 2 * NCOLORS; i++) {
+    initializePermutationTable(&DihedralTables[i], &dihedralGroup[i]);
+  }
+  for (uint32_t i = 0; i < NAUTOMORPHISMS; i++) {
+    initializePermutationTable(
+        &AutomorphismTables[i],
+        s6Automorphism(NCYCLES - NAUTOMORPHISMS + i));
+  }
+  for (CYCLE_ID i = 0; i < NCYCLES; i++) {
+    ReversedCycleIds[i] = cycleIdReverseDirection(i);
+  }
+  for (int j = 0; j < 2 * NCOLORS; j++) {
+    for (int i = 0; i < PREFIX_LENGTH; i++) {
+      PrefixPermutations[j][i] =
+          InverseSequenceOrder[DihedralTables[j].colorSet[SequenceOrder[i]]];
+      assert(PrefixPermutations[j][i] < PREFIX_LENGTH);
+    }
+  }
+}
+
+/* The table for s6Automorphism(cycleId). */
+static struct permutationTable *automorphismTable(CYCLE_ID cycleId)
+{
+  assert(Cycles[cycleId].length == NCOLORS);
+  return &AutomorphismTables[cycleId - (NCYCLES - NAUTOMORPHISMS)];
+}
+
 static FACE_DEGREE_SEQUENCE getFaceDegreesInCanonicalOrder()
 {
   FACE_DEGREE_SEQUENCE faceDegrees = NEW(FACE_DEGREE_SEQUENCE);
   for (int i = 0; i < NFACES; i++) {
-    faceDegrees->faceDegrees[i] = Faces[SequenceOrder[i]].cycle->length;
+    faceDegrees->faceDegrees[i] = Context.faces[SequenceOrder[i]].cycle->length;
   }
   return faceDegrees;
 }
@@ -158,9 +224,9 @@ static FACE_DEGREE_SEQUENCE sortPermutationsOfSequence(
   for (i = 0; i < count; i++) {
     for (int j = 0; j < 2 * NCOLORS; j++) {
       for (int k = 0; k < NFACES; k++) {
+        COLORSET permuted = DihedralTables[j].colorSet[SequenceOrder[k]];
         sequences[i * 2 * NCOLORS + j].faceDegrees[k] =
-            next->faceDegrees[InverseSequenceOrder[colorSetPermute(
-                SequenceOrder[k], &dihedralGroup[j])]];
+            next->faceDegrees[InverseSequenceOrder[permuted]];
       }
     }
     if (count - i > 1) {
@@ -206,62 +272,45 @@ static SYMMETRY_TYPE getPartialSequenceCanonicity(int n,
   return getFullSequenceCanonicity(sizes);
 }
 
-/* Creates mirror image by reversing cycle orientations */
-static SIGNATURE s6SignatureReflected(SIGNATURE sequence)
+/* Signatures are ordered by memcmp, so their cycle ids are too. */
+static int cycleIdCompare(CYCLE_ID a, CYCLE_ID b)
 {
-  SIGNATURE result = NEW(SIGNATURE);
-  for (int i = 0; i < NFACES; i++) {
-    result->classSignature.faceCycleId[i] =
-        cycleIdReverseDirection(sequence->classSignature.faceCycleId[i]);
-  }
-  result->offset = sequence->offset;
-  result->reflected = !sequence->reflected;
-  return result;
+  return memcmp(&a, &b, sizeof(a));
 }
 
-static SIGNATURE s6SignaturePermuted(SIGNATURE sequence,
-                                     PERMUTATION permutation)
+/*
+ * A candidate for s6MaxSignature is the current diagram recentered on the
+ * face center, maybe reflected, then relabelled by the automorphism of its
+ * central cycle, which makes that cycle (a b c ...), and then by rotation,
+ * one of the rotations of the colors.
+ *
+ * This computes the candidate into candidate, face by face, and compares it
+ * with best as it goes. Returns false as soon as the candidate is less than
+ * best, or at the end if it is equal.
+ */
+static bool s6CandidateIsGreater(CYCLE_ID *candidate, CYCLE_ID *best,
+                                 COLORSET center, bool reflected,
+                                 struct permutationTable *automorphism,
+                                 struct permutationTable *rotation)
 {
-  SIGNATURE result = NEW(SIGNATURE);
+  COLORSET face;
+  CYCLE_ID cycleId;
+  int comparison = 0;
   for (COLORSET i = 0; i < NFACES; i++) {
-    result->classSignature.faceCycleId[colorSetPermute(i, permutation)] =
-        s6PermuteCycleId(sequence->classSignature.faceCycleId[i], permutation);
-  }
-  result->offset = colorSetPermute(sequence->offset, permutation);
-  result->reflected = sequence->reflected;
-  return result;
-}
-
-/* Shifts reference frame to make 'center' the new central face */
-static SIGNATURE s6SignatureRecentered(SIGNATURE sequence, COLORSET center)
-{
-  SIGNATURE result = NEW(SIGNATURE);
-  for (int i = 0; i < NFACES; i++) {
-    result->classSignature.faceCycleId[i] =
-        sequence->classSignature.faceCycleId[i ^ center];
-  }
-  result->offset = center ^ sequence->offset;
-  result->reflected = sequence->reflected;
-  return result;
-}
-
-/* Finds maximum signature under all cyclic color permutations */
-static SIGNATURE maxSpunSignature(SIGNATURE onCurrentFace)
-{
-  int counter;
-  PERMUTATION abcNCycle = &dihedralGroup[1];
-  SIGNATURE best = onCurrentFace;
-  PERMUTATION permutation =
-      s6Automorphism(onCurrentFace->classSignature.faceCycleId[0]);
-  SIGNATURE permuted = s6SignaturePermuted(onCurrentFace, permutation);
-  for (counter = 0; counter < NFACES; counter++) {
-    assert(permuted->classSignature.faceCycleId[0] == NCYCLES - 1);
-    if (s6SignatureCompare(permuted, best) > 0) {
-      best = permuted;
+    face = automorphism->inverseColorSet[rotation->inverseColorSet[i]];
+    cycleId = Context.faces[face ^ center].cycle - Cycles;
+    if (reflected) {
+      cycleId = ReversedCycleIds[cycleId];
+    }
+    candidate[i] = rotation->cycleId[automorphism->cycleId[cycleId]];
+    if (comparison == 0) {
+      comparison = cycleIdCompare(candidate[i], best[i]);
+      if (comparison < 0) {
+        return false;
+      }
     }
-    permuted = s6SignaturePermuted(permuted, abcNCycle);
   }
-  return best;
+  return comparison > 0;
 }
 
 /* Priority order: single-color faces, then faces with colors 0 and NCOLORS-1,
@@ -294,45 +343,65 @@ void initializeS6(void)
     InverseSequenceOrder[SequenceOrder[i]] = i;
   }
   verifyS6Initialization(done, ix);
+  initializePermutationTables();
 }
 
 SIGNATURE s6SignatureFromFaces(void)
 {
   SIGNATURE result = NEW(SIGNATURE);
   for (int i = 0; i < NFACES; i++) {
-    result->classSignature.faceCycleId[i] = Faces[i].cycle - Cycles;
+    result->classSignature.faceCycleId[i] = Context.faces[i].cycle - Cycles;
   }
   result->offset = NFACES - 1;
   result->reflected = false;
   return result;
 }
 
-/* Computes diagram's canonical representation across all symmetries and face
- * centrings */
+/*
+ * Computes diagram's canonical representation across all symmetries and face
+ * centrings: the maximum candidate, see s6CandidateIsGreater, and the first
+ * such in the order of the loops. The result is overwritten by the next
+ * call.
+ */
 SIGNATURE s6MaxSignature(void)
 {
-  int resultsIndex = 0;
-  SIGNATURE fromFaces = s6SignatureFromFaces();
-  COLORSET center = 0;
-  SIGNATURE recentered;
-  SIGNATURE results[NFACES * 2];
-
-  // Try each face as a potential center
+  static THREAD_LOCAL struct signature Result;
+  CYCLE_ID buffers[2][NFACES];
+  CYCLE_ID *best = buffers[0], *candidate = buffers[1], *swap;
+  COLORSET center;
+  CYCLE_ID centralCycleId;
+  struct permutationTable *automorphism, *rotation;
+  int reflected, r;
+
+  memset(best, 0, sizeof(buffers[0]));
   for (center = 0; center < NFACES; center++) {
-    if (Faces[center].cycle->length == NCOLORS) {
-      // Recenter the signature around this face
-      recentered = s6SignatureRecentered(fromFaces, center);
-
-      // Compute signatures for both orientations
-      results[resultsIndex++] = maxSpunSignature(recentered);
-      results[resultsIndex++] =
-          maxSpunSignature(s6SignatureReflected(recentered));
+    if (Context.faces[center].cycle->length != NCOLORS) {
+      continue;
+    }
+    for (reflected = 0; reflected < 2; reflected++) {
+      centralCycleId = Context.faces[center].cycle - Cycles;
+      if (reflected) {
+        centralCycleId = ReversedCycleIds[centralCycleId];
+      }
+      automorphism = automorphismTable(centralCycleId);
+      for (r = 0; r < NCOLORS; r++) {
+        rotation = &DihedralTables[r];
+        if (s6CandidateIsGreater(candidate, best, center, reflected,
+                                 automorphism, rotation)) {
+          assert(candidate[0] == NCYCLES - 1);
+          swap = best;
+          best = candidate;
+          candidate = swap;
+          Result.offset =
+              rotation->colorSet[automorphism->colorSet[center ^
+                                                        (NFACES - 1)]];
+          Result.reflected = reflected;
+        }
+      }
     }
   }
-
-  // Find the lexicographically maximum signature
-  qsort(results, resultsIndex, sizeof(results[0]), compareCycleIdSequence);
-  return results[0];
+  memcpy(Result.classSignature.faceCycleId, best, sizeof(buffers[0]));
+  return &Result;
 }
 
 SYMMETRY_TYPE s6FacesSymmetryType(void)
@@ -340,6 +409,28 @@ SYMMETRY_TYPE s6FacesSymmetryType(void)
   return getFullSequenceCanonicity(getFaceDegreesInCanonicalOrder());
 }
 
+bool s6PrefixIsNonCanonical(void)
+{
+  FACE_DEGREE degrees[PREFIX_LENGTH], image;
+  CYCLE cycle;
+  for (int i = 0; i < PREFIX_LENGTH; i++) {
+    cycle = Context.faces[SequenceOrder[i]].cycle;
+    degrees[i] = cycle == NULL ? 0 : cycle->length;
+  }
+  for (int j = 1; j < 2 * NCOLORS; j++) {
+    for (int i = 0; i < PREFIX_LENGTH; i++) {
+      image = degrees[PrefixPermutations[j][i]];
+      if (image == 0 || degrees[i] == 0 || image < degrees[i]) {
+        break;
+      }
+      if (image > degrees[i]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 SYMMETRY_TYPE s6SymmetryType6(FACE_DEGREE *args)
 {
   struct faceDegreeSequence argsAsSequence = {
@@ -349,7 +440,7 @@ SYMMETRY_TYPE s6SymmetryType6(FACE_DEGREE *args)
 
 char *s6FaceDegreeSignature(void)
 {
-  static char Result[NCOLORS + 1];
+  static THREAD_LOCAL char Result[NCOLORS + 1];
   FACE_DEGREE_SEQUENCE faceDegrees = getFaceDegreesInCanonicalOrder();
   for (int i = 0; i < NCOLORS; i++) {
     Result[i] = '0' + faceDegrees->faceDegrees[i];
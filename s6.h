@@ -91,6 +91,7 @@ extern SIGNATURE s6SignatureFromFaces(void);
 
 /**
  * Get the maximum signature across all possible rotations/reflections.
+ * The result is overwritten by the next call in the same thread.
  */
 extern SIGNATURE s6MaxSignature(void);
 
@@ -110,6 +111,14 @@ extern char *s6FaceDegreeSignature(void);
  */
 extern SYMMETRY_TYPE s6FacesSymmetryType(void);
 
+/**
+ * Whether the degrees of the faces without one color, or without two
+ * adjacent colors, which start the canonical order, already show that the
+ * diagram is not canonical. Faces without a cycle have unknown degrees,
+ * which stop the comparison with each image under the dihedral group.
+ */
+extern bool s6PrefixIsNonCanonical(void);
+
 /**
  * Analyze symmetry of a given face degree sequence.
  */
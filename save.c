@@ -1,6 +1,9 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#include "archive.h"
 #include "common.h"
+#include "compact.h"
+#include "compress.h"
 #include "face.h"
 #include "main.h"
 #include "predicates.h"
@@ -8,17 +11,18 @@
 #include "statistics.h"
 #include "utils.h"
 #include "visible_for_testing.h"
+#include "writer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
 
-int PerFaceDegreeSolutionNumberIPC;
-int VariationCountIPC;
-static char* currentFilename;
-static FILE* currentFile;
-static int currentNumberOfVariations;
-static char currentVariationMultiplication[128];
+THREAD_LOCAL int PerFaceDegreeSolutionNumberIPC;
+THREAD_LOCAL int VariationCountIPC;
+static THREAD_LOCAL char* currentFilename;
+static THREAD_LOCAL FILE* currentFile;
+static THREAD_LOCAL int currentNumberOfVariations;
+static THREAD_LOCAL char currentVariationMultiplication[128];
 
 /* Count variations and build multiplication string for display */
 int searchCountVariations(void)
@@ -58,7 +62,7 @@ static void solutionPrint(FILE* fp)
     FACE face = Faces + colors;
     do {
       char buffer[1024];
-      FACE next = face->next;
+      FACE next = FACE_STATE(face)->next;
       COLORSET colorBeingDropped = face->colors & ~next->colors;
       COLORSET colorBeingAdded = next->colors & ~face->colors;
       sprintf(buffer, "%s [%c,%c] ", faceToString(face),
@@ -76,7 +80,7 @@ static void solutionPrint(FILE* fp)
     if (colors == (NFACES - 1)) {
       break;
     }
-    colors |= (face->previous->colors | 1);
+    colors |= (FACE_STATE(face)->previous->colors | 1);
   }
 }
 
@@ -97,6 +101,20 @@ static bool gateSave(void)
   return true;
 }
 
+/* Opens the one file for all the variations of the solution, with -c or -a */
+static FILE* openVariationsFile(const char* extension)
+{
+  char* buffer = getBuffer();
+  FILE* result;
+  sprintf(buffer, "%s%s", CurrentPrefixIPC, extension);
+  result = GraphmlFileOps.fopen(usingBuffer(buffer), "wb");
+  if (result == NULL) {
+    perror(buffer);
+    exit(EXIT_FAILURE);
+  }
+  return result;
+}
+
 static bool beforeVariantsSave(void)
 {
   char* buffer = getBuffer();
@@ -113,13 +131,30 @@ static bool beforeVariantsSave(void)
   VariationNumberIPC = 1;
   solutionPrint(currentFile);
   CurrentPrefixIPC[strlen(CurrentPrefixIPC) - 4] = '\0';
-  GraphmlFileOps.initializeFolder(CurrentPrefixIPC);
   currentNumberOfVariations = searchCountVariations();
   LevelsIPC = numberOfLevels(currentNumberOfVariations);
   fprintf(currentFile, "\nSolution signature %s\nClass signature %s\n",
           s6SignatureToString(s6SignatureFromFaces()),
           s6SignatureToString(s6MaxSignature()));
   fflush(currentFile);
+  if (CompactOutputFlag) {
+    CompactFileIPC = openVariationsFile(COMPACT_EXTENSION);
+    compactWriteSolution(CompactFileIPC);
+  } else if (ArchiveOutputFlag) {
+    archiveBegin(&ArchiveIPC, openVariationsFile(ARCHIVE_EXTENSION),
+                 LevelsIPC);
+  } else if (CompressOutputFlag) {
+    /* The dictionary is the text file so far: the solution. */
+    buffer = getBuffer();
+    sprintf(buffer, "%s.txt", CurrentPrefixIPC);
+    compressBegin(&CompressorIPC, openVariationsFile(COMPRESS_EXTENSION),
+                  LevelsIPC, usingBuffer(buffer), ftell(currentFile));
+  } else {
+    GraphmlFileOps.initializeFolder(CurrentPrefixIPC);
+    if (NumberOfWriterThreadsFlag > 0) {
+      writerBeginSolution();
+    }
+  }
 
   return true;
 }
@@ -132,7 +167,62 @@ static void afterVariantsSave(void)
           currentVariationMultiplication);
   VariationCountIPC += VariationNumberIPC - 1;
   fclose(currentFile);
+  if (CompactOutputFlag) {
+    fclose(CompactFileIPC);
+    CompactFileIPC = NULL;
+  } else if (ArchiveOutputFlag) {
+    archiveEnd(&ArchiveIPC);
+  } else if (CompressOutputFlag) {
+    compressEnd(&CompressorIPC);
+  } else if (NumberOfWriterThreadsFlag > 0) {
+    writerFlush();
+  }
 }
 
 FORWARD_BACKWARD_PREDICATE(Save, gateSave, beforeVariantsSave,
                            afterVariantsSave)
+
+void countPrintHeading(void)
+{
+  printf("Face Degree | Soln | Variations | Corner Choices | (multiplied)\n");
+  printf("------ | -- | --- | ---- | ---\n");
+}
+
+/**
+ * Prints the solution as a row of the table in docs/RESULTS.md, counting
+ * its variations without enumerating them. This is the end of the -C
+ * program, so it always fails.
+ */
+static struct predicateResult tryCount(int round)
+{
+  char choices[sizeof(currentVariationMultiplication) * 2];
+  char* p = choices;
+  uint64 numberOfVariations;
+  int multiplied;
+  (void)round;
+  if (!gateSave()) {
+    return PredicateFail;
+  }
+  multiplied = searchCountVariations();
+  numberOfVariations = cornersCountVariations();
+  /* "*2*4" becomes "2×4" */
+  choices[0] = '\0';
+  for (char* q = currentVariationMultiplication; *q; q++) {
+    if (*q != '*') {
+      *p++ = *q;
+    } else if (q != currentVariationMultiplication) {
+      p += sprintf(p, "×");
+    }
+  }
+  *p = '\0';
+  VariationCountIPC += numberOfVariations;
+  GlobalVariantCountIPC += numberOfVariations;
+  flockfile(stdout);
+  printf("%s | %2.2d | %llu | %s | %d\n", s6FaceDegreeSignature(),
+         PerFaceDegreeSolutionNumberIPC, numberOfVariations, choices,
+         multiplied);
+  funlockfile(stdout);
+  return PredicateFail;
+}
+
+struct predicate CountPredicate = {"Count", tryCount, NULL, NULL};
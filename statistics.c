@@ -1,21 +1,82 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#define _GNU_SOURCE
 #include "statistics.h"
 
 #include "face.h"
 #include "main.h"
 
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
 
-static Statistic Statistics[MAX_STATISTICS];
-static Failure* Failures[MAX_STATISTICS];
+/* The statistics and failures of this thread, in the order included. */
+static THREAD_LOCAL Statistic* Statistics = NULL;
+static THREAD_LOCAL int NumberOfStatistics = 0;
+static THREAD_LOCAL Failure** Failures = NULL;
+static THREAD_LOCAL int NumberOfFailures = 0;
 static time_t StartTime;
-static time_t LastLogTime;
+static THREAD_LOCAL time_t LastLogTime;
 static int CheckFrequency = 1;
 static int SecondsBetweenLogs = 10;
-static int CheckCountDown = 0;
+static THREAD_LOCAL int CheckCountDown = 0;
 static FILE* LogFile = NULL;
 
+/*
+ * Totals of finished search threads, matched with the counters of
+ * each thread by name. Each total has its own allocation, since the
+ * counters of the main thread may point to them. Protected by TotalsMutex.
+ */
+static pthread_mutex_t TotalsMutex = PTHREAD_MUTEX_INITIALIZER;
+static Statistic* TotalStatistics = NULL;
+static int NumberOfTotalStatistics = 0;
+static Failure** TotalFailures = NULL;
+static int NumberOfTotalFailures = 0;
+
+/* The counters and failures of this thread at the last statisticMark. */
+static THREAD_LOCAL uint64* MarkedCounts = NULL;
+static THREAD_LOCAL int NumberOfMarkedCounts = 0;
+static THREAD_LOCAL uint64 (*MarkedFailures)[NFACES] = NULL;
+static THREAD_LOCAL int NumberOfMarkedFailures = 0;
+
+/*
+ * The statistics stream (-J): a JSON object per line, written at most
+ * every STREAM_SECONDS, looking at the clock every STREAM_FREQUENCY calls
+ * of statisticStreamMaybeWrite, and at the end.
+ */
+#define STREAM_SECONDS 1
+#define STREAM_FREQUENCY 1000
+static FILE* StreamFile = NULL;
+static struct timespec StreamStart;
+static THREAD_LOCAL struct timespec LastStreamTime;
+static THREAD_LOCAL int StreamCountDown = STREAM_FREQUENCY;
+/* The threads are numbered as they first write to the stream. */
+static atomic_int NumberOfStreamThreads;
+static THREAD_LOCAL int StreamThread = -1;
+
+/* Returns array, with room for one more element of size. */
+static void* growArray(void* array, int length, size_t size)
+{
+  array = realloc(array, (length + 1) * size);
+  if (array == NULL) {
+    perror("realloc");
+    exit(EXIT_FAILURE);
+  }
+  return array;
+}
+
+static void* allocateZeroed(size_t size)
+{
+  void* result = calloc(1, size);
+  if (result == NULL) {
+    perror("calloc");
+    exit(EXIT_FAILURE);
+  }
+  return result;
+}
+
 static void formatElapsedTimeHMS(time_t elapsed, char* buffer,
                                  size_t bufferSize)
 {
@@ -27,8 +88,8 @@ static double calculateLogSearchSpace(void)
 {
   double result = 0.0;
   for (uint32_t i = 0; i < NFACES; i++) {
-    if (Faces[i].cycle == NULL) {
-      result += log(Faces[i].cycleSetSize);
+    if (Context.faces[i].cycle == NULL && Context.faces[i].cycleSetSize > 0) {
+      result += log(Context.faces[i].cycleSetSize);
     }
   }
   return result;
@@ -38,7 +99,7 @@ static int countFacesWithChosenCycle(void)
 {
   int result = 0;
   for (uint32_t i = 0; i < NFACES; i++) {
-    if (Faces[i].cycle != NULL) {
+    if (Context.faces[i].cycle != NULL) {
       result += 1;
     }
   }
@@ -90,9 +151,9 @@ static void printFailureCounts(bool oneLine)
   if (!VerboseModeFlag) {
     return;  // Skip failures in non-verbose mode
   }
-  for (int i = 0; i < MAX_STATISTICS; i++) {
+  for (int i = 0; i < NumberOfFailures; i++) {
     if (Failures[i]->count[0] == 0) {
-      break;
+      continue;
     }
 
     int maxIndex = findHighestDepthWithNonZeroCount(Failures[i]);
@@ -105,13 +166,12 @@ static void printFailureCounts(bool oneLine)
   }
 }
 
-static void printStatisticsCounters(bool oneLine)
+/* Prints either the details, or the other statistics. */
+static void printStatisticsCounters(bool oneLine, bool details)
 {
-  for (int i = 0; i < MAX_STATISTICS; i++) {
-    if (Statistics[i].countPtr == NULL) {
-      break;
-    }
-    if (!Statistics[i].verboseOnly || VerboseModeFlag) {
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    if (Statistics[i].detail == details &&
+        (!Statistics[i].verboseOnly || VerboseModeFlag)) {
       if (oneLine) {
         fprintf(LogFile, "%s %llu ", Statistics[i].shortName,
                 *Statistics[i].countPtr);
@@ -143,36 +203,406 @@ void initializeStatisticLogging(char* filename, int frequency, int seconds)
   initializeFailures();
 }
 
-void statisticIncludeInteger(uint64* counter, char* shortName, char* name,
-                             bool verboseOnly)
+static void includeStatistic(uint64* counter, char* shortName, char* name,
+                             bool verboseOnly, bool maximum, bool detail)
 {
-  for (int i = 0; i < MAX_STATISTICS; i++) {
+  for (int i = 0; i < NumberOfStatistics; i++) {
     if (Statistics[i].countPtr == counter) {
       return;
     }
-    if (Statistics[i].countPtr == NULL) {
-      Statistics[i].countPtr = counter;
-      Statistics[i].shortName = shortName;
-      Statistics[i].name = name;
-      Statistics[i].verboseOnly = verboseOnly;
+    /* Takes over the count, see statisticRestoreTotal. */
+    if (Statistics[i].restored && strcmp(Statistics[i].name, name) == 0) {
+      *counter = *Statistics[i].countPtr;
+      free(Statistics[i].countPtr);
+      free(Statistics[i].shortName);
+      free(Statistics[i].name);
+      Statistics[i] = (Statistic){.name = name,
+                                  .shortName = shortName,
+                                  .countPtr = counter,
+                                  .verboseOnly = verboseOnly,
+                                  .maximum = maximum,
+                                  .detail = detail};
       return;
     }
   }
-  assert(false);
+  Statistics = growArray(Statistics, NumberOfStatistics, sizeof(Statistic));
+  Statistics[NumberOfStatistics++] = (Statistic){.name = name,
+                                                 .shortName = shortName,
+                                                 .countPtr = counter,
+                                                 .verboseOnly = verboseOnly,
+                                                 .maximum = maximum,
+                                                 .detail = detail};
+}
+
+void statisticIncludeInteger(uint64* counter, char* shortName, char* name,
+                             bool verboseOnly)
+{
+  includeStatistic(counter, shortName, name, verboseOnly, false, false);
+}
+
+/* Like statisticIncludeInteger, for high water marks. */
+void statisticIncludeMaximum(uint64* counter, char* shortName, char* name,
+                             bool verboseOnly)
+{
+  includeStatistic(counter, shortName, name, verboseOnly, true, false);
+}
+
+/* Like statisticIncludeInteger, for counters that are too many to log as
+ * the search goes: they are only in the full report. */
+void statisticIncludeDetail(uint64* counter, char* shortName, char* name)
+{
+  includeStatistic(counter, shortName, name, false, false, true);
 }
 
 void statisticIncludeFailure(Failure* failure)
 {
-  for (int i = 0; i < MAX_STATISTICS; i++) {
+  for (int i = 0; i < NumberOfFailures; i++) {
     if (Failures[i] == failure) {
       return;
     }
-    if (Failures[i] == 0) {
-      Failures[i] = failure;
-      return;
+  }
+  Failures = growArray(Failures, NumberOfFailures, sizeof(Failure*));
+  Failures[NumberOfFailures++] = failure;
+}
+
+static void combineCount(uint64* total, uint64 count, bool maximum)
+{
+  if (!maximum) {
+    *total += count;
+  } else if (count > *total) {
+    *total = count;
+  }
+}
+
+/* The index of the statistic called name, or number if there is none. */
+static int findStatistic(Statistic* statistics, int number, char* name)
+{
+  int i;
+  for (i = 0; i < number; i++) {
+    if (strcmp(statistics[i].name, name) == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+/* The index of the failure with label, or number if there is none. */
+static int findFailure(Failure** failures, int number, const char* label)
+{
+  int i;
+  for (i = 0; i < number; i++) {
+    if (strcmp(failures[i]->label, label) == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+/* Adds a total like statistic, with a counter of its own, and returns its
+ * index. */
+static int newTotalStatistic(Statistic statistic)
+{
+  TotalStatistics =
+      growArray(TotalStatistics, NumberOfTotalStatistics, sizeof(Statistic));
+  statistic.countPtr = allocateZeroed(sizeof(uint64));
+  statistic.restored = false;
+  TotalStatistics[NumberOfTotalStatistics] = statistic;
+  return NumberOfTotalStatistics++;
+}
+
+static int newTotalFailure(char* label, char* shortLabel)
+{
+  Failure* failure = allocateZeroed(sizeof(Failure));
+  failure->label = label;
+  failure->shortLabel = shortLabel;
+  TotalFailures =
+      growArray(TotalFailures, NumberOfTotalFailures, sizeof(Failure*));
+  TotalFailures[NumberOfTotalFailures] = failure;
+  return NumberOfTotalFailures++;
+}
+
+static void addFailureCounts(Failure* total, Failure* failure)
+{
+  for (int k = 0; k < NFACES; k++) {
+    total->count[k] += failure->count[k];
+  }
+}
+
+/**
+ * Called by each search thread as it finishes, to add its counters
+ * into the shared totals.
+ */
+void statisticSaveThreadTotals(void)
+{
+  pthread_mutex_lock(&TotalsMutex);
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    int j = findStatistic(TotalStatistics, NumberOfTotalStatistics,
+                          Statistics[i].name);
+    if (j == NumberOfTotalStatistics) {
+      j = newTotalStatistic(Statistics[i]);
+    }
+    combineCount(TotalStatistics[j].countPtr, *Statistics[i].countPtr,
+                 Statistics[i].maximum);
+  }
+  for (int i = 0; i < NumberOfFailures; i++) {
+    int j = findFailure(TotalFailures, NumberOfTotalFailures,
+                        Failures[i]->label);
+    if (j == NumberOfTotalFailures) {
+      j = newTotalFailure(Failures[i]->label, Failures[i]->shortLabel);
+    }
+    addFailureCounts(TotalFailures[j], Failures[i]);
+  }
+  pthread_mutex_unlock(&TotalsMutex);
+  free(MarkedCounts);
+  free(MarkedFailures);
+  MarkedCounts = NULL;
+  MarkedFailures = NULL;
+  NumberOfMarkedCounts = NumberOfMarkedFailures = 0;
+}
+
+/**
+ * Called by the thread that started the search threads, after they have
+ * all finished, to add the shared totals into its own counters. Counters
+ * this thread does not have are reported directly from the totals.
+ */
+void statisticAddThreadTotals(void)
+{
+  for (int j = 0; j < NumberOfTotalStatistics; j++) {
+    int i = findStatistic(Statistics, NumberOfStatistics,
+                          TotalStatistics[j].name);
+    if (i == NumberOfStatistics) {
+      Statistics = growArray(Statistics, NumberOfStatistics, sizeof(Statistic));
+      Statistics[NumberOfStatistics++] = TotalStatistics[j];
+    } else if (Statistics[i].countPtr != TotalStatistics[j].countPtr) {
+      combineCount(Statistics[i].countPtr, *TotalStatistics[j].countPtr,
+                   Statistics[i].maximum);
+      *TotalStatistics[j].countPtr = 0;
+    }
+  }
+  for (int j = 0; j < NumberOfTotalFailures; j++) {
+    int i = findFailure(Failures, NumberOfFailures, TotalFailures[j]->label);
+    if (i == NumberOfFailures) {
+      Failures = growArray(Failures, NumberOfFailures, sizeof(Failure*));
+      Failures[NumberOfFailures++] = TotalFailures[j];
+    } else if (Failures[i] != TotalFailures[j]) {
+      addFailureCounts(Failures[i], TotalFailures[j]);
+      memset(TotalFailures[j]->count, 0, sizeof(TotalFailures[j]->count));
+    }
+  }
+}
+
+/* Returns the failure of this thread with label, or NULL. */
+Failure* statisticFindFailure(const char* label)
+{
+  int i = findFailure(Failures, NumberOfFailures, label);
+  return i < NumberOfFailures ? Failures[i] : NULL;
+}
+
+/**
+ * Unless keep, sets the counters of this thread, but not the high water
+ * marks, back to what they were at the last mark, or zero; then marks
+ * them. The search threads of engineParallel all do the work between the
+ * tasks, and only one of them keeps its counts.
+ */
+void statisticMark(bool keep)
+{
+  if (!keep) {
+    for (int i = 0; i < NumberOfStatistics; i++) {
+      if (!Statistics[i].maximum) {
+        *Statistics[i].countPtr =
+            i < NumberOfMarkedCounts ? MarkedCounts[i] : 0;
+      }
+    }
+    for (int i = 0; i < NumberOfFailures; i++) {
+      if (i < NumberOfMarkedFailures) {
+        memcpy(Failures[i]->count, MarkedFailures[i],
+               sizeof(Failures[i]->count));
+      } else {
+        memset(Failures[i]->count, 0, sizeof(Failures[i]->count));
+      }
+    }
+  }
+  MarkedCounts = realloc(MarkedCounts, NumberOfStatistics * sizeof(uint64));
+  MarkedFailures =
+      realloc(MarkedFailures, NumberOfFailures * sizeof(MarkedFailures[0]));
+  if ((MarkedCounts == NULL && NumberOfStatistics > 0) ||
+      (MarkedFailures == NULL && NumberOfFailures > 0)) {
+    perror("realloc");
+    exit(EXIT_FAILURE);
+  }
+  NumberOfMarkedCounts = NumberOfStatistics;
+  NumberOfMarkedFailures = NumberOfFailures;
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    MarkedCounts[i] = *Statistics[i].countPtr;
+  }
+  for (int i = 0; i < NumberOfFailures; i++) {
+    memcpy(MarkedFailures[i], Failures[i]->count, sizeof(MarkedFailures[i]));
+  }
+}
+
+/**
+ * Sets the counters of this thread back to zero.
+ */
+void statisticResetCounters(void)
+{
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    *Statistics[i].countPtr = 0;
+  }
+  for (int i = 0; i < NumberOfFailures; i++) {
+    memset(Failures[i]->count, 0, sizeof(Failures[i]->count));
+  }
+}
+
+/**
+ * Writes the counters of this thread to file, one per line, in the form
+ * read by statisticReadTotal. This is how worker processes report their
+ * statistics, see multiprocess.c.
+ */
+void statisticWriteTotals(FILE* file)
+{
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    fprintf(file, "#statistic %d %d %d %llu %s %s\n", Statistics[i].maximum,
+            Statistics[i].verboseOnly, Statistics[i].detail,
+            *Statistics[i].countPtr, Statistics[i].shortName,
+            Statistics[i].name);
+  }
+  for (int i = 0; i < NumberOfFailures; i++) {
+    fprintf(file, "#failure %s", Failures[i]->shortLabel);
+    for (int k = 0; k < NFACES; k++) {
+      fprintf(file, " %llu", Failures[i]->count[k]);
     }
+    fprintf(file, " %s\n", Failures[i]->label);
   }
-  assert(false);
+}
+
+static char* copyRestOfLine(const char* text)
+{
+  return strndup(text, strcspn(text, "\n"));
+}
+
+static void readStatisticTotal(int maximum, int verboseOnly, int detail,
+                               uint64 count, const char* shortName,
+                               const char* rest)
+{
+  char* name = copyRestOfLine(rest);
+  pthread_mutex_lock(&TotalsMutex);
+  int j = findStatistic(TotalStatistics, NumberOfTotalStatistics, name);
+  if (j == NumberOfTotalStatistics) {
+    j = newTotalStatistic((Statistic){.name = name,
+                                      .shortName = strdup(shortName),
+                                      .verboseOnly = verboseOnly,
+                                      .maximum = maximum,
+                                      .detail = detail});
+  } else {
+    free(name);
+  }
+  combineCount(TotalStatistics[j].countPtr, count, maximum);
+  pthread_mutex_unlock(&TotalsMutex);
+}
+
+/* Reads the counts of a #failure line into failure, and returns the rest of
+ * the line, the label, or NULL. */
+static const char* readFailureCounts(Failure* failure, const char* counts)
+{
+  char* end;
+  for (int k = 0; k < NFACES; k++) {
+    failure->count[k] = strtoull(counts, &end, 10);
+    if (end == counts || *end != ' ') {
+      return NULL;
+    }
+    counts = end + 1;
+  }
+  return counts;
+}
+
+static bool readFailureTotal(const char* shortLabel, const char* counts)
+{
+  Failure failure;
+  counts = readFailureCounts(&failure, counts);
+  if (counts == NULL) {
+    return false;
+  }
+  char* label = copyRestOfLine(counts);
+  pthread_mutex_lock(&TotalsMutex);
+  int j = findFailure(TotalFailures, NumberOfTotalFailures, label);
+  if (j == NumberOfTotalFailures) {
+    j = newTotalFailure(label, strdup(shortLabel));
+  } else {
+    free(label);
+  }
+  addFailureCounts(TotalFailures[j], &failure);
+  pthread_mutex_unlock(&TotalsMutex);
+  return true;
+}
+
+/**
+ * If line was written by statisticWriteTotals, adds it into the shared
+ * totals, like statisticSaveThreadTotals, and returns true.
+ */
+bool statisticReadTotal(const char* line)
+{
+  int maximum, verboseOnly, detail, length;
+  uint64 count;
+  char shortName[32];
+  if (sscanf(line, "#statistic %d %d %d %llu %31s %n", &maximum, &verboseOnly,
+             &detail, &count, shortName, &length) == 5) {
+    readStatisticTotal(maximum, verboseOnly, detail, count, shortName,
+                       line + length);
+    return true;
+  }
+  if (sscanf(line, "#failure %31s %n", shortName, &length) == 1) {
+    return readFailureTotal(shortName, line + length);
+  }
+  return false;
+}
+
+/**
+ * If line was written by statisticWriteTotals, sets the counter of this
+ * thread with the same name to it, and returns true. This is how a
+ * checkpoint is resumed, see checkpoint.c. High water marks are left alone.
+ * A counter that this thread does not have yet, such as the calls of a
+ * predicate after the Venn predicate, is included with a count of its own,
+ * which is taken over if the counter itself is included later.
+ */
+bool statisticRestoreTotal(const char* line)
+{
+  int maximum, verboseOnly, detail, length, i;
+  uint64 count;
+  char shortName[32];
+  char* name;
+  Failure failure;
+  const char* label;
+  if (sscanf(line, "#statistic %d %d %d %llu %31s %n", &maximum, &verboseOnly,
+             &detail, &count, shortName, &length) == 5) {
+    name = copyRestOfLine(line + length);
+    i = findStatistic(Statistics, NumberOfStatistics, name);
+    if (maximum) {
+      free(name);
+    } else if (i < NumberOfStatistics) {
+      *Statistics[i].countPtr = count;
+      free(name);
+    } else {
+      includeStatistic(allocateZeroed(sizeof(uint64)), strdup(shortName),
+                       name, verboseOnly, false, detail);
+      *Statistics[NumberOfStatistics - 1].countPtr = count;
+      Statistics[NumberOfStatistics - 1].restored = true;
+    }
+    return true;
+  }
+  if (sscanf(line, "#failure %31s %n", shortName, &length) == 1) {
+    label = readFailureCounts(&failure, line + length);
+    if (label == NULL) {
+      return false;
+    }
+    name = copyRestOfLine(label);
+    i = findFailure(Failures, NumberOfFailures, name);
+    if (i < NumberOfFailures) {
+      memcpy(Failures[i]->count, failure.count, sizeof(failure.count));
+    }
+    free(name);
+    return true;
+  }
+  return false;
 }
 
 void statisticPrintOneLine(int position, bool force)
@@ -181,28 +611,123 @@ void statisticPrintOneLine(int position, bool force)
     time_t now = time(NULL);
     double seconds = difftime(now, LastLogTime);
     if (seconds >= SecondsBetweenLogs || force) {
-      char* timestr = asctime(localtime(&now));
+      struct tm local;
+      char timestr[16];
       time_t elapsed = now - StartTime;
-      timestr[19] = 0;
+      strftime(timestr, sizeof(timestr), "%H:%M:%S",
+               localtime_r(&now, &local));
 
       char elapsedStr[20];
       formatElapsedTimeHMS(elapsed, elapsedStr, sizeof(elapsedStr));
 
+      /* Keep the line together when several search threads are logging. */
+      flockfile(LogFile);
       if (VerboseModeFlag) {
-        fprintf(LogFile, "%s %s %d %.1f p %d ", timestr + 11, elapsedStr,
+        fprintf(LogFile, "%s %s %d %.1f p %d ", timestr, elapsedStr,
                 countFacesWithChosenCycle(), calculateLogSearchSpace(),
                 position);
       }
 
-      printStatisticsCounters(true);
+      printStatisticsCounters(true, false);
       printFailureCounts(true);
       fprintf(LogFile, "\n");
+      funlockfile(LogFile);
 
       updateLoggingState(now);
     }
   }
 }
 
+static double secondsBetween(struct timespec* start, struct timespec* end)
+{
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void initializeStatisticStream(const char* filename)
+{
+  StreamFile = fopen(filename, "w");
+  if (StreamFile == NULL) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &StreamStart);
+}
+
+static void writeJsonString(const char* text)
+{
+  putc('"', StreamFile);
+  for (; *text != '\0'; text++) {
+    if (*text == '"' || *text == '\\') {
+      putc('\\', StreamFile);
+    }
+    putc(*text, StreamFile);
+  }
+  putc('"', StreamFile);
+}
+
+/*
+ * Writes a line of the statistics stream, e.g.
+ *   {"time":1760731810.123,"elapsed":12.345,"pid":4321,"thread":0,
+ *    "final":false,"counters":{"forced":3083060,...},
+ *    "failures":{"No matching cycles":[273332,169063,49660],...}}
+ * with the time since the epoch, the seconds since the stream started, all
+ * the counters of this thread, and the count of each failure at each depth,
+ * up to the deepest.
+ */
+static void writeStreamRecord(bool final)
+{
+  struct timespec now, wallClock;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  clock_gettime(CLOCK_REALTIME, &wallClock);
+  LastStreamTime = now;
+  if (StreamThread < 0) {
+    StreamThread = atomic_fetch_add(&NumberOfStreamThreads, 1);
+  }
+  flockfile(StreamFile);
+  fprintf(StreamFile,
+          "{\"time\":%.3f,\"elapsed\":%.3f,\"pid\":%d,\"thread\":%d,"
+          "\"final\":%s,\"counters\":{",
+          wallClock.tv_sec + wallClock.tv_nsec / 1e9,
+          secondsBetween(&StreamStart, &now), (int)getpid(), StreamThread,
+          final ? "true" : "false");
+  for (int i = 0; i < NumberOfStatistics; i++) {
+    if (i > 0) {
+      putc(',', StreamFile);
+    }
+    writeJsonString(Statistics[i].name);
+    fprintf(StreamFile, ":%llu", *Statistics[i].countPtr);
+  }
+  fputs("},\"failures\":{", StreamFile);
+  for (int i = 0; i < NumberOfFailures; i++) {
+    int maxIndex = findHighestDepthWithNonZeroCount(Failures[i]);
+    if (i > 0) {
+      putc(',', StreamFile);
+    }
+    writeJsonString(Failures[i]->label);
+    putc(':', StreamFile);
+    for (int k = 0; k <= maxIndex; k++) {
+      fprintf(StreamFile, "%c%llu", k == 0 ? '[' : ',', Failures[i]->count[k]);
+    }
+    putc(']', StreamFile);
+  }
+  fputs("}}\n", StreamFile);
+  fflush(StreamFile);
+  funlockfile(StreamFile);
+}
+
+void statisticStreamMaybeWrite(void)
+{
+  struct timespec now;
+  if (StreamFile == NULL || --StreamCountDown > 0) {
+    return;
+  }
+  StreamCountDown = STREAM_FREQUENCY;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (secondsBetween(&LastStreamTime, &now) >= STREAM_SECONDS) {
+    writeStreamRecord(false);
+  }
+}
+
 void statisticPrintFull(void)
 {
   time_t now = time(NULL);
@@ -225,9 +750,13 @@ void statisticPrintFull(void)
 
   fprintf(LogFile, "%30s %30s\n", "Counter", "Value(s)");
 
-  printStatisticsCounters(false);
+  printStatisticsCounters(false, false);
   printFailureCounts(false);
+  printStatisticsCounters(false, true);
 
   fprintf(LogFile, "\n");
   updateLoggingState(now);
+  if (StreamFile != NULL) {
+    writeStreamRecord(true);
+  }
 }
@@ -10,17 +10,19 @@
 
 /**
  * Statistics tracking system for monitoring algorithm performance.
+ * Any number of counters can be included. As well as the human readable
+ * log, they can be written as a stream of JSON lines (-J).
  */
 
-/* Maximum number of statistics that can be tracked */
-#define MAX_STATISTICS 10
-
 /* Structure for tracking a single statistic */
 struct statistic {
   char *name;       /* Full descriptive name */
   char *shortName;  /* Abbreviated name for compact display */
   uint64 *countPtr; /* Pointer to the counter value */
   bool verboseOnly; /* Only display in verbose mode */
+  bool maximum;     /* Combine threads by maximum rather than sum */
+  bool detail;      /* Only display in the full report, after the others */
+  bool restored;    /* From a checkpoint, until the counter is included */
 };
 
 typedef struct statistic Statistic;
@@ -28,14 +30,38 @@ typedef struct statistic Statistic;
 /* Initialization and configuration */
 extern void initializeStatisticLogging(char *filename, int frequency,
                                        int seconds);
+extern void initializeStatisticStream(const char *filename);
 
 /* Counter registration */
 extern void statisticIncludeInteger(uint64 *counter, char *shortName,
                                     char *name, bool verboseOnly);
+extern void statisticIncludeMaximum(uint64 *counter, char *shortName,
+                                    char *name, bool verboseOnly);
+extern void statisticIncludeDetail(uint64 *counter, char *shortName,
+                                   char *name);
 extern void statisticIncludeFailure(FAILURE failure);
+/* The failures of this thread, including those added by
+ * statisticAddThreadTotals, are also found by label. */
+extern FAILURE statisticFindFailure(const char *label);
+
+/* Combining the statistics of search threads, see engineParallel */
+extern void statisticSaveThreadTotals(void);
+extern void statisticAddThreadTotals(void);
+extern void statisticMark(bool keep);
+
+/* Passing the statistics of worker processes, see multiprocessRun */
+extern void statisticResetCounters(void);
+extern void statisticWriteTotals(FILE *file);
+extern bool statisticReadTotal(const char *line);
+
+/* Resuming the statistics of a checkpoint, see checkpoint.c */
+extern bool statisticRestoreTotal(const char *line);
 
 /* Output and reporting */
 extern void statisticPrintOneLine(int position, bool force);
 extern void statisticPrintFull(void);
+/* Called at each call of the Venn predicate; writes a line of the stream,
+ * if any, about once a second. */
+extern void statisticStreamMaybeWrite(void);
 
 #endif  // STATISTICS_H
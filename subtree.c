@@ -0,0 +1,71 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "subtree.h"
+
+#include "engine.h"
+
+#include <stdlib.h>
+
+/* The path to the call of -s. */
+static struct choicePoint Path[MAX_STACK_SIZE];
+
+/* The engine has stopped at a call: print its address. */
+static void printAddress(void)
+{
+  struct choicePoint path[MAX_STACK_SIZE];
+  int length = enginePath(path);
+  flockfile(stdout);
+  for (int i = 0; i < length - 1; i++) {
+    if (i > 0) {
+      putchar('.');
+    }
+    if (path[i].choice < 0) {
+      putchar('-');
+    } else {
+      printf("%d", path[i].choice);
+    }
+  }
+  putchar('\n');
+  funlockfile(stdout);
+}
+
+void subtreeSplit(int depth)
+{
+  engineStopAt(depth, printAddress);
+}
+
+bool subtreeSearch(const char* address)
+{
+  int length = 0;
+  char* end;
+  while (*address != '\0') {
+    if (length == MAX_STACK_SIZE - 1) {
+      return false;
+    }
+    if (*address == '-') {
+      Path[length].choice = -1;
+      end = (char*)address + 1;
+    } else {
+      Path[length].choice = strtol(address, &end, 10);
+      if (end == address || Path[length].choice < 0) {
+        return false;
+      }
+    }
+    /* Any call will do: the choices determine the path. */
+    Path[length++].predicate = NULL;
+    if (*end == '.') {
+      end++;
+      if (*end == '\0') {
+        return false;
+      }
+    } else if (*end != '\0') {
+      return false;
+    }
+    address = end;
+  }
+  Path[length].predicate = NULL;
+  Path[length].choice = -1;
+  engineSubtree(Path, length + 1);
+  return true;
+}
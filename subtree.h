@@ -0,0 +1,25 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef SUBTREE_H
+#define SUBTREE_H
+
+#include "core.h"
+
+/**
+ * Splitting the search into jobs. The address of a call in the search tree
+ * is the current choice of each entry of the engine stack below it, see
+ * enginePath, separated by '.', with '-' for an entry without choices,
+ * e.g. "0.0.1.1.3.3.1.-.0". With -S depth, the calls at that depth are
+ * not made, and their addresses are printed instead, one per line; then
+ * each job, with -s address and the same other options, searches only
+ * below its call. Between them, the jobs search the whole tree.
+ */
+
+/* Prints the address of each call at depth, instead of making it. */
+extern void subtreeSplit(int depth);
+
+/* Makes the engine search only below the call at address. Returns false
+ * if address is not an address. */
+extern bool subtreeSearch(const char* address);
+
+#endif  // SUBTREE_H
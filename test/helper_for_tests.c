@@ -12,12 +12,13 @@ FACE dynamicFaceAddSpecific(char* colors, char* cycle)
   FAILURE failure;
   FACE face = faceFromColors(colors);
   uint32_t cycleId = cycleIdFromColors(cycle);
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, face->possibleCycles));
-  if (face->cycleSetSize == 1) {
-    TEST_ASSERT_EQUAL(face->cycle, cycleSetFirst(face->possibleCycles));
-    TEST_ASSERT_EQUAL(face->cycle, Cycles + cycleId);
+  struct faceState* state = FACE_STATE(face);
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, state->possibleCycles));
+  if (state->cycleSetSize == 1) {
+    TEST_ASSERT_EQUAL(state->cycle, cycleSetFirst(state->possibleCycles));
+    TEST_ASSERT_EQUAL(state->cycle, Cycles + cycleId);
   } else {
-    TRAIL_SET_POINTER(&face->cycle, Cycles + cycleId);
+    TRAIL_SET_POINTER(&state->cycle, Cycles + cycleId);
     failure = dynamicFaceBacktrackableChoice(face);
 
     if (failure != NULL) {
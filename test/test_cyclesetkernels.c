@@ -0,0 +1,166 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "cyclesetkernels.h"
+#include "utils.h"
+#include "visible_for_testing.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+
+#define NSETS 64
+#define BENCHMARK_ROUNDS 200000
+
+static const char *KernelNames[] = {"scalar", "popcnt"};
+static CYCLESET_DECLARE Sets[NSETS];
+static uint64 Stamps[CYCLESET_LENGTH];
+
+static uint64 Random = 0x9e3779b97f4a7c15ull;
+
+static uint64 nextRandom(void)
+{
+  Random ^= Random << 13;
+  Random ^= Random >> 7;
+  Random ^= Random << 17;
+  return Random;
+}
+
+/* Mostly sparse sets, like the possible cycles of a face, with a few edge
+ * cases at the start. */
+static void makeSets(void)
+{
+  uint32_t i, j;
+  memset(Sets, 0, sizeof(Sets));
+  initializeCycleSetUniversal(Sets[1]);
+  cycleSetAdd(0, Sets[2]);
+  cycleSetAdd(NCYCLES - 1, Sets[3]);
+  cycleSetAdd(0, Sets[4]);
+  cycleSetAdd(NCYCLES - 1, Sets[4]);
+  for (i = 5; i < NSETS; i++) {
+    for (j = 0; j < i % 12; j++) {
+      cycleSetAdd(nextRandom() % NCYCLES, Sets[i]);
+    }
+    if (i % 5 == 0) {
+      initializeCycleSetUniversal(Sets[i]);
+      cycleSetRemove(nextRandom() % NCYCLES, Sets[i]);
+    }
+  }
+}
+
+void setUp(void)
+{
+  initialize();
+  makeSets();
+}
+
+void tearDown(void)
+{
+  initializeCycleSetKernels();
+}
+
+static uint32_t expectedSize(CYCLESET cycleSet)
+{
+  uint32_t size = 0;
+  for (CYCLE_ID i = 0; i < NCYCLES; i++) {
+    size += cycleSetMember(i, cycleSet);
+  }
+  return size;
+}
+
+static void checkKernels(const char *name)
+{
+  uint32_t i, j, k, size, removed;
+  CYCLESET_DECLARE restricted;
+  TRAIL startTrail = trailBacktrackPoint();
+  if (!cycleSetUseKernels(name)) {
+    TEST_IGNORE_MESSAGE("Not supported by this CPU");
+  }
+  for (i = 0; i < NSETS; i++) {
+    size = expectedSize(Sets[i]);
+    TEST_ASSERT_EQUAL(size, CycleSetKernels->size(Sets[i]));
+    for (j = 0; j < NSETS; j++) {
+      memcpy(restricted, Sets[i], sizeof(restricted));
+      removed = CycleSetKernels->restrictTo(restricted, Stamps, Sets[j]);
+      for (k = 0; k < CYCLESET_LENGTH; k++) {
+        TEST_ASSERT_EQUAL_UINT64(Sets[i][k] & Sets[j][k], restricted[k]);
+      }
+      TEST_ASSERT_EQUAL(size - expectedSize(restricted), removed);
+      trailRewindTo(startTrail);
+      TEST_ASSERT_EQUAL(0, memcmp(restricted, Sets[i], sizeof(restricted)));
+    }
+  }
+}
+
+static void testScalarKernels(void)
+{
+  checkKernels("scalar");
+}
+
+static void testPopcntKernels(void)
+{
+  checkKernels("popcnt");
+}
+
+static void testUnknownKernels(void)
+{
+  TEST_ASSERT_FALSE(cycleSetUseKernels("avx2"));
+}
+
+static double nanosecondsSince(struct timespec *start, uint64 operations)
+{
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return ((end.tv_sec - start->tv_sec) * 1e9 +
+          (end.tv_nsec - start->tv_nsec)) /
+         operations;
+}
+
+/* Prints the time per call of each kernel, on the same sets; only run by
+ * make benchmarks. */
+static void testBenchmarkKernels(void)
+{
+  uint32_t i, j, round;
+  uint64 total = 0;
+  struct timespec start;
+  CYCLESET_DECLARE restricted;
+  TRAIL startTrail = trailBacktrackPoint();
+  for (i = 0; i < sizeof(KernelNames) / sizeof(KernelNames[0]); i++) {
+    if (!cycleSetUseKernels(KernelNames[i])) {
+      continue;
+    }
+    printf("%-7s", KernelNames[i]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (round = 0; round < BENCHMARK_ROUNDS; round++) {
+      for (j = 0; j < NSETS; j++) {
+        total += CycleSetKernels->size(Sets[j]);
+      }
+    }
+    printf(" size %5.1fns",
+           nanosecondsSince(&start, BENCHMARK_ROUNDS * NSETS));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (round = 0; round < BENCHMARK_ROUNDS / 4; round++) {
+      for (j = 0; j < NSETS; j++) {
+        memcpy(restricted, Sets[j], sizeof(restricted));
+        total += CycleSetKernels->restrictTo(restricted, Stamps,
+                                             Sets[NSETS - 1 - j]);
+        trailRewindTo(startTrail);
+      }
+    }
+    printf(" restrictTo %5.1fns\n",
+           nanosecondsSince(&start, BENCHMARK_ROUNDS / 4 * NSETS));
+  }
+  TEST_ASSERT_NOT_EQUAL(0, total);
+}
+
+int main(int argc, char *argv[])
+{
+  UNITY_BEGIN();
+  if (argc > 1 && strcmp(argv[1], "benchmark") == 0) {
+    RUN_TEST(testBenchmarkKernels);
+    return UNITY_END();
+  }
+  RUN_TEST(testScalarKernels);
+  RUN_TEST(testPopcntKernels);
+  RUN_TEST(testUnknownKernels);
+  return UNITY_END();
+}
@@ -1,7 +1,9 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
 #define _GNU_SOURCE
+#include "archive.h"
 #include "common.h"
+#include "compress.h"
 #include "face.h"
 #include "helper_for_tests.h"
 #include "main.h"
@@ -9,16 +11,18 @@
 #include "s6.h"
 #include "statistics.h"
 #include "utils.h"
+#include "writer.h"
 
 #include <regex.h>
 #include <search.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <unity.h>
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 static int FopenCount = 0;
-extern int VariationNumberIPC;
+extern THREAD_LOCAL int VariationNumberIPC;
 struct nodeInfo {
   char id[64];
   struct colorInfo {
@@ -384,6 +388,129 @@ static void backwardVariant14188(void)
 FORWARD_BACKWARD_PREDICATE_STATIC(Variant14188, NULL, forwardVariant14188,
                                   backwardVariant14188)
 
+static char ArchiveFilename[] = "/tmp/test_archiveXXXXXX";
+static bool forwardArchive(void)
+{
+  int fd = mkstemp(ArchiveFilename);
+  TEST_ASSERT_NOT_EQUAL(-1, fd);
+  MaxVariantsPerSolutionFlag = 10;
+  IgnoreFirstVariantsPerSolution = 0;
+  ArchiveOutputFlag = true;
+  archiveBegin(&ArchiveIPC, fdopen(fd, "wb"), LevelsIPC);
+  return true;
+}
+
+static void backwardArchive(void)
+{
+  struct archive archive;
+  size_t length;
+  char* data;
+  ArchiveOutputFlag = false;
+  archiveEnd(&ArchiveIPC);
+  TEST_ASSERT_TRUE(archiveOpen(&archive, fopen(ArchiveFilename, "rb")));
+  unlink(ArchiveFilename);
+  TEST_ASSERT_EQUAL(1, archive.firstVariation);
+  TEST_ASSERT_EQUAL(10, archive.count);
+  TEST_ASSERT_NULL(archiveRead(&archive, 11, &length));
+  data = archiveRead(&archive, 7, &length);
+  TEST_ASSERT_NOT_NULL(data);
+  TEST_ASSERT_EQUAL(strlen(data), length);
+  TEST_ASSERT_LESS_THAN(sizeof(outputBuffer), length);
+  strcpy(outputBuffer, data);
+  free(data);
+  archiveClose(&archive);
+  forwardGraphML();
+  matchAndVerifyNodeCount();
+  verifyAllNodes();
+  freeRegexes();
+}
+FORWARD_BACKWARD_PREDICATE_STATIC(Archive, NULL, forwardArchive,
+                                  backwardArchive)
+
+#define COMPRESS_TEXT "Solution text, which is the start of the dictionary\n"
+static char CompressPrefix[] = "/tmp/test_compressXXXXXX";
+static char CompressFilename[sizeof(CompressPrefix) + 4];
+static char CompressTextFilename[sizeof(CompressPrefix) + 4];
+static bool forwardCompress(void)
+{
+  int fd = mkstemp(CompressPrefix);
+  FILE* text;
+  TEST_ASSERT_NOT_EQUAL(-1, fd);
+  close(fd);
+  unlink(CompressPrefix);
+  sprintf(CompressFilename, "%s" COMPRESS_EXTENSION, CompressPrefix);
+  sprintf(CompressTextFilename, "%s.txt", CompressPrefix);
+  text = fopen(CompressTextFilename, "w");
+  TEST_ASSERT_NOT_NULL(text);
+  fputs(COMPRESS_TEXT "Not in the dictionary\n", text);
+  fclose(text);
+  MaxVariantsPerSolutionFlag = 10;
+  IgnoreFirstVariantsPerSolution = 0;
+  CompressOutputFlag = true;
+  compressBegin(&CompressorIPC, fopen(CompressFilename, "wb"), LevelsIPC,
+                CompressTextFilename, strlen(COMPRESS_TEXT));
+  return true;
+}
+
+static void backwardCompress(void)
+{
+  CompressOutputFlag = false;
+  compressEnd(&CompressorIPC);
+  FopenCount = 0;
+  compressExpand(CompressFilename);
+  unlink(CompressFilename);
+  unlink(CompressTextFilename);
+  /* The last variation expanded is left in outputBuffer. */
+  TEST_ASSERT_EQUAL(10, FopenCount);
+  TEST_ASSERT_EQUAL(10, VariationNumberIPC);
+  forwardGraphML();
+  matchAndVerifyNodeCount();
+  verifyAllNodes();
+  freeRegexes();
+}
+FORWARD_BACKWARD_PREDICATE_STATIC(Compress, NULL, forwardCompress,
+                                  backwardCompress)
+
+/* One writer thread, since every file is written to outputBuffer. */
+static bool forwardWriter(void)
+{
+  MaxVariantsPerSolutionFlag = 10;
+  IgnoreFirstVariantsPerSolution = 0;
+  NumberOfWriterThreadsFlag = 1;
+  writerStart(1);
+  writerBeginSolution();
+  return true;
+}
+
+static void backwardWriter(void)
+{
+  writerFlush();
+  writerStop();
+  NumberOfWriterThreadsFlag = 0;
+  TEST_ASSERT_EQUAL(10, FopenCount);
+  forwardGraphML();
+  matchAndVerifyNodeCount();
+  verifyAllNodes();
+  freeRegexes();
+}
+FORWARD_BACKWARD_PREDICATE_STATIC(Writer, NULL, forwardWriter, backwardWriter)
+
+static uint64 ExpectedVariations;
+static bool forwardClosedFormCount(void)
+{
+  MaxVariantsPerSolutionFlag = INT_MAX;
+  IgnoreFirstVariantsPerSolution = 0;
+  ExpectedVariations = cornersCountVariations();
+  return true;
+}
+
+static void backwardClosedFormCount(void)
+{
+  TEST_ASSERT_EQUAL(ExpectedVariations, VariationNumberIPC - 1);
+}
+FORWARD_BACKWARD_PREDICATE_STATIC(ClosedFormCount, NULL, forwardClosedFormCount,
+                                  backwardClosedFormCount)
+
 static bool forwardVariant1319(void)
 {
   /* Test output: 555444-64/27/005.xml (variant 1319 = 0x5*0x100+0x27) */
@@ -506,6 +633,22 @@ static PREDICATE Variant14188[] = {
     &InitializePredicate, &Variant14188Predicate, &CheckGraphMLPredicate,
     &InnerFacePredicate,  &VennPredicate,         &GatePredicate,
     &CornersPredicate,    &GraphMLPredicate,      &FAILPredicate};
+static PREDICATE Archive[] = {
+    &InitializePredicate, &ArchivePredicate, &InnerFacePredicate,
+    &VennPredicate,       &GatePredicate,    &CornersPredicate,
+    &GraphMLPredicate,    &FAILPredicate};
+static PREDICATE Compress[] = {
+    &InitializePredicate, &CompressPredicate, &InnerFacePredicate,
+    &VennPredicate,       &GatePredicate,     &CornersPredicate,
+    &GraphMLPredicate,    &FAILPredicate};
+static PREDICATE Writer[] = {
+    &InitializePredicate, &InnerFacePredicate, &VennPredicate,
+    &GatePredicate,       &WriterPredicate,    &CornersPredicate,
+    &GraphMLPredicate,    &FAILPredicate};
+static PREDICATE ClosedFormCount[] = {
+    &InitializePredicate, &InnerFacePredicate,      &VennPredicate,
+    &GatePredicate,       &ClosedFormCountPredicate, &CornersPredicate,
+    &GraphMLPredicate,    &FAILPredicate};
 static PREDICATE Variant1319[] = {
     &InitializePredicate, &Variant1319Predicate, &CheckGraphMLPredicate,
     &InnerFacePredicate,  &VennPredicate,        &GatePredicate,
@@ -583,10 +726,15 @@ int main(void)
   RUN_654444(Basic);
   RUN_654444(Variant14188);
   RUN_654444(CheckGraphML);
+  RUN_654444(Archive);
+  RUN_654444(Compress);
+  RUN_654444(Writer);
+  RUN_654444(ClosedFormCount);
   RUN_645534(Basic);
   RUN_645534(EstimateCount);
   RUN_645534(ExactCount);
   RUN_645534(CheckGraphML);
+  RUN_645534(ClosedFormCount);
   RUN_KNOWN(Basic);
   RUN_KNOWN(Variant1319);
   RUN_CORNER_COUNT(0, 8);
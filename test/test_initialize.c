@@ -40,6 +40,18 @@ static void testLastCycles(void)
                 6 * sizeof(uint32_t)));
 }
 
+static void testCycleIds(void)
+{
+  CYCLE_ID i;
+  initialize();
+  for (i = 0; i < NCYCLES; i++) {
+    TEST_ASSERT_EQUAL(i, getCycleId(Cycles[i].curves, Cycles[i].length));
+    TEST_ASSERT_EQUAL(i, cycleIdReverseDirection(cycleIdReverseDirection(i)));
+  }
+  TEST_ASSERT_EQUAL(NCYCLES - 1, cycleIdFromColors("abcdef"));
+  TEST_ASSERT_EQUAL(NCYCLES - 2, cycleIdFromColors("abcdfe"));
+}
+
 static void testContains2(void)
 {
   CYCLE cycle = &Cycles[0];
@@ -177,7 +189,7 @@ static void testFaceChoiceCount(void)
   for (faceColors = 0, face = Faces; faceColors < NFACES;
        faceColors++, face++) {
     TEST_ASSERT_EQUAL(expected[__builtin_popcount(faceColors)],
-                      face->cycleSetSize);
+                      FACE_STATE(face)->cycleSetSize);
   }
 }
 
@@ -188,7 +200,7 @@ static void testNextCycle(void)
   CYCLE cycle = NULL;
   initialize();
   do {
-    cycle = cycleSetNext(face->possibleCycles, cycle);
+    cycle = cycleSetNext(FACE_STATE(face)->possibleCycles, cycle);
     counter++;
   } while (cycle != NULL);
 
@@ -201,6 +213,7 @@ int main(void)
   RUN_TEST(testInitialize);
   RUN_TEST(testSizeOfCycleSet);
   RUN_TEST(testLastCycles);
+  RUN_TEST(testCycleIds);
   RUN_TEST(testSameAndOppositeDirections);
   RUN_TEST(testFaceChoiceCount);
   RUN_TEST(testOppositeDirections);
@@ -1,6 +1,7 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
 #include "common.h"
+#include "compact.h"
 #include "face.h"
 #include "helper_for_tests.h"
 #include "s6.h"
@@ -289,7 +290,7 @@ void setUp(void)
   initializeStatisticLogging("/dev/stdout", 20, 5);
   if (trail == NULL) {
     dynamicFaceSetupCentral(args);
-    trail = Trail;
+    trail = trailBacktrackPoint();
   }
   CycleGuessCounterIPC = 1;
 }
@@ -309,12 +310,13 @@ static void addFacesFromTestData(char* testData[][2], int length)
   for (i = 0; i < length; i++) {
     face = faceFromColors(testData[i][0]);
     cycleId = cycleIdFromColors(testData[i][1]);
-    TEST_ASSERT_TRUE(cycleSetMember(cycleId, face->possibleCycles));
-    if (face->cycleSetSize == 1) {
-      TEST_ASSERT_EQUAL(Cycles + cycleId, cycleSetFirst(face->possibleCycles));
-      TEST_ASSERT_EQUAL(face->cycle, Cycles + cycleId);
+    struct faceState* state = FACE_STATE(face);
+    TEST_ASSERT_TRUE(cycleSetMember(cycleId, state->possibleCycles));
+    if (state->cycleSetSize == 1) {
+      TEST_ASSERT_EQUAL(Cycles + cycleId, cycleSetFirst(state->possibleCycles));
+      TEST_ASSERT_EQUAL(state->cycle, Cycles + cycleId);
     } else {
-      TRAIL_SET_POINTER(&face->cycle, Cycles + cycleId);
+      TRAIL_SET_POINTER(&state->cycle, Cycles + cycleId);
       failure = dynamicFaceBacktrackableChoice(face);
       if (failure != NULL) {
         printf("Failure: %s %s\n", failure->label, failure->shortLabel);
@@ -427,26 +429,76 @@ static void testDE1(void)
   FACE ab = faceFromColors("ab");
   FACE abc = faceFromColors("abc");
   uint32_t cycleId = cycleIdFromColors("afceb");
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
   addFaceFromTestData("abc");
 #if DEBUG
-  dynamicCycleSetPrint(abc->cycle->oppositeDirection[0]);
+  dynamicCycleSetPrint(FACE_STATE(abc)->cycle->oppositeDirection[0]);
 #endif
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, abc->cycle->oppositeDirection[0]));
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(
+      cycleSetMember(cycleId, FACE_STATE(abc)->cycle->oppositeDirection[0]));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
   addFaceFromTestData("abce");
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
 }
 
 static void testDE2(void)
 {
   FACE ab = faceFromColors("ab");
   uint32_t cycleId = cycleIdFromColors("afceb");
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
   addFaceFromTestData("abce");
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
   addFaceFromTestData("abc");
-  TEST_ASSERT_TRUE(cycleSetMember(cycleId, ab->possibleCycles));
+  TEST_ASSERT_TRUE(cycleSetMember(cycleId, FACE_STATE(ab)->possibleCycles));
+}
+
+static void testContextClone(void)
+{
+  struct searchContext clone;
+  FACE ab = faceFromColors("ab");
+  addFaceFromTestData("abc");
+  contextClone(&clone);
+  TEST_ASSERT_EQUAL(0, memcmp(&Context, &clone, sizeof(clone)));
+  TEST_ASSERT_NULL(FACE_STATE(ab)->cycle);
+  addFaceFromTestData("ab");
+  TEST_ASSERT_NOT_NULL(FACE_STATE(ab)->cycle);
+  TEST_ASSERT_NULL(clone.faces[ab->colors].cycle);
+  contextRestore(&clone);
+  TEST_ASSERT_NULL(FACE_STATE(ab)->cycle);
+  TEST_ASSERT_EQUAL(0, memcmp(&Context, &clone, sizeof(clone)));
+}
+
+static void testCompactRoundTrip(void)
+{
+  FILE* fp = tmpfile();
+  CYCLE cycles[NFACES];
+  EDGE corners[NCOLORS][3], readCorners[NCOLORS][3];
+  addFacesFromTestData(testData3, sizeof(testData3) / sizeof(testData3[0]));
+  addFacesFromTestData(testData4, sizeof(testData4) / sizeof(testData4[0]));
+  addFacesFromTestData(testData5, sizeof(testData5) / sizeof(testData5[0]));
+  addFacesFromTestData(testData6, sizeof(testData6) / sizeof(testData6[0]));
+  for (uint32_t i = 0; i < NFACES; i++) {
+    cycles[i] = Context.faces[i].cycle;
+  }
+  for (COLOR a = 0; a < NCOLORS; a++) {
+    corners[a][0] = &Faces[NFACES - 1 - a].edges[a];
+    corners[a][1] = &Faces[a].edges[a];
+    corners[a][2] = NULL;
+  }
+  compactWriteSolution(fp);
+  compactWriteVariation(fp, 70000, corners);
+  trailRewindTo(trail);
+  TEST_ASSERT_NULL(FACE_STATE(faceFromColors("ab"))->cycle);
+
+  rewind(fp);
+  TEST_ASSERT_TRUE(dynamicCompactReadSolution(fp));
+  for (uint32_t i = 0; i < NFACES; i++) {
+    TEST_ASSERT_EQUAL(cycles[i], Context.faces[i].cycle);
+  }
+  TEST_ASSERT_EQUAL(70000, compactReadVariation(fp, readCorners));
+  TEST_ASSERT_EQUAL(0, memcmp(corners, readCorners, sizeof(corners)));
+  TEST_ASSERT_EQUAL(0, compactReadVariation(fp, readCorners));
+  fclose(fp);
 }
 
 int main(void)
@@ -460,5 +512,7 @@ int main(void)
   RUN_TEST(testDE1);
   RUN_TEST(testDE2);
   RUN_TEST(testInOrder);
+  RUN_TEST(testContextClone);
+  RUN_TEST(testCompactRoundTrip);
   return UNITY_END();
 }
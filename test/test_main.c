@@ -2,6 +2,7 @@
 
 #define _GNU_SOURCE
 
+#include "engine.h"
 #include "main.h"
 
 #include <getopt.h>
@@ -50,11 +51,90 @@ static void testMainArguments(void)
   int argc4 = sizeof(argv4) / sizeof(argv4[0]);
   char *argv5[] = {"program"};
   int argc5 = sizeof(argv5) / sizeof(argv5[0]);
+  char *argv6[] = {"program", "-f", "foo", "-T", "4", "-m", "10"};
+  int argc6 = sizeof(argv6) / sizeof(argv6[0]);
+  char *argv7[] = {"program", "-f", "foo", "-T", "4",
+                   "-d",      "555444", "-m",  "1"};
+  int argc7 = sizeof(argv7) / sizeof(argv7[0]);
+  char *argv8[] = {"program", "-f", "foo", "-P", "4"};
+  int argc8 = sizeof(argv8) / sizeof(argv8[0]);
+  char *argv9[] = {"program", "-f", "foo", "-P", "4", "-T", "2"};
+  int argc9 = sizeof(argv9) / sizeof(argv9[0]);
+  char *argv10[] = {"program", "-f", "foo", "-P", "4", "-k", "3"};
+  int argc10 = sizeof(argv10) / sizeof(argv10[0]);
+  char *argv11[] = {"program", "-f", "foo", "-c"};
+  int argc11 = sizeof(argv11) / sizeof(argv11[0]);
+  char *argv12[] = {"program", "-x", "foo/555444-01.var"};
+  int argc12 = sizeof(argv12) / sizeof(argv12[0]);
+  char *argv13[] = {"program", "-f", "foo", "-a"};
+  int argc13 = sizeof(argv13) / sizeof(argv13[0]);
+  char *argv14[] = {"program", "-f", "foo", "-a", "-c"};
+  int argc14 = sizeof(argv14) / sizeof(argv14[0]);
+  char *argv15[] = {"program", "-f", "foo", "-z"};
+  int argc15 = sizeof(argv15) / sizeof(argv15[0]);
+  char *argv16[] = {"program", "-f", "foo", "-z", "-a"};
+  int argc16 = sizeof(argv16) / sizeof(argv16[0]);
+  char *argv17[] = {"program", "-f", "foo", "-w", "2"};
+  int argc17 = sizeof(argv17) / sizeof(argv17[0]);
+  char *argv18[] = {"program", "-f", "foo", "-w", "2", "-c"};
+  int argc18 = sizeof(argv18) / sizeof(argv18[0]);
+  char *argv19[] = {"program", "-C"};
+  int argc19 = sizeof(argv19) / sizeof(argv19[0]);
+  char *argv20[] = {"program", "-C", "-f", "foo"};
+  int argc20 = sizeof(argv20) / sizeof(argv20[0]);
+  char *argv21[] = {"program", "-e", "100"};
+  int argc21 = sizeof(argv21) / sizeof(argv21[0]);
+  char *argv22[] = {"program", "-e", "100", "-T", "4"};
+  int argc22 = sizeof(argv22) / sizeof(argv22[0]);
+  char *argv23[] = {"program", "-C", "-r", "checkpoint"};
+  int argc23 = sizeof(argv23) / sizeof(argv23[0]);
+  char *argv24[] = {"program", "-C", "-r", "checkpoint", "-T", "4"};
+  int argc24 = sizeof(argv24) / sizeof(argv24[0]);
+  char *argv25[] = {"program", "-C", "-S", "10"};
+  int argc25 = sizeof(argv25) / sizeof(argv25[0]);
+  char *argv26[] = {"program", "-f", "foo", "-s", "0.0.1.-.2"};
+  int argc26 = sizeof(argv26) / sizeof(argv26[0]);
+  char *argv27[] = {"program", "-C", "-S", "10", "-s", "0.0.1.-.2"};
+  int argc27 = sizeof(argv27) / sizeof(argv27[0]);
+  char *argv28[] = {"program", "-f", "foo", "-s", "0.0.1.-.2", "-P", "4"};
+  int argc28 = sizeof(argv28) / sizeof(argv28[0]);
+  char *argv29[] = {"program", "-C", "-T", "4", "-J", "/dev/null"};
+  int argc29 = sizeof(argv29) / sizeof(argv29[0]);
+  char *argv30[] = {"program", "-f", "foo", "-p"};
+  int argc30 = sizeof(argv30) / sizeof(argv30[0]);
+  char *argv31[] = {"program", "-C", "-S", "10", "-p"};
+  int argc31 = sizeof(argv31) / sizeof(argv31[0]);
 
   // Redirect stdout to a buffer
   TEST_ASSERT_EQUAL_INT(0, run(argc1, argv1));
   TEST_ASSERT_NOT_EQUAL_INT(0, run(argc4, argv4));
   TEST_ASSERT_NOT_EQUAL_INT(0, run(argc5, argv5));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc6, argv6));
+  TEST_ASSERT_EQUAL_INT(0, run(argc7, argv7));
+  TEST_ASSERT_EQUAL_INT(0, run(argc8, argv8));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc9, argv9));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc10, argv10));
+  TEST_ASSERT_EQUAL_INT(0, run(argc11, argv11));
+  TEST_ASSERT_EQUAL_INT(0, run(argc12, argv12));
+  TEST_ASSERT_EQUAL_INT(0, run(argc13, argv13));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc14, argv14));
+  TEST_ASSERT_EQUAL_INT(0, run(argc15, argv15));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc16, argv16));
+  TEST_ASSERT_EQUAL_INT(0, run(argc17, argv17));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc18, argv18));
+  TEST_ASSERT_EQUAL_INT(0, run(argc19, argv19));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc20, argv20));
+  TEST_ASSERT_EQUAL_INT(0, run(argc21, argv21));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc22, argv22));
+  TEST_ASSERT_EQUAL_INT(0, run(argc23, argv23));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc24, argv24));
+  TEST_ASSERT_EQUAL_INT(0, run(argc25, argv25));
+  TEST_ASSERT_EQUAL_INT(0, run(argc26, argv26));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc27, argv27));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc28, argv28));
+  TEST_ASSERT_EQUAL_INT(0, run(argc29, argv29));
+  TEST_ASSERT_EQUAL_INT(0, run(argc30, argv30));
+  TEST_ASSERT_NOT_EQUAL_INT(0, run(argc31, argv31));
 }
 
 int main(void)
@@ -82,6 +162,18 @@ void initializeStatisticLogging(char *filename, int frequency, int seconds)
 { /* stub for testing. */
 }
 
+void initializeStatisticStream(const char *filename)
+{ /* stub for testing. */
+}
+
+void profileStart(void)
+{ /* stub for testing. */
+}
+
+void profilePrint(void)
+{ /* stub for testing. */
+}
+
 void searchFull(void (*foundSolution)(void))
 { /* stub for testing. */
 }
@@ -96,12 +188,92 @@ void searchSolutionWrite(const char *buffer)
 }
 
 struct predicate *NonDeterministicProgram[] = {/* stub for testing. */};
+struct predicate *NonDeterministicCountProgram[] = {/* stub for testing. */};
+struct predicate *NonDeterministicEstimateProgram[] = {/* stub for testing. */};
+
+void countPrintHeading(void)
+{ /* stub for testing. */
+}
+
+void estimatePrintHeading(void)
+{ /* stub for testing. */
+}
+
+void estimatePrintTotals(void)
+{ /* stub for testing. */
+}
+
+bool checkpointResume(const char *filename)
+{ /* stub for testing. */
+  (void)filename;
+  return false;
+}
+
+void checkpointFinish(const char *filename)
+{ /* stub for testing. */
+  (void)filename;
+}
+
+void subtreeSplit(int depth)
+{ /* stub for testing. */
+  (void)depth;
+}
+
+bool subtreeSearch(const char *address)
+{ /* stub for testing. */
+  (void)address;
+  return true;
+}
 
 void engine(struct predicate *predicates[])
 {
   /* stub for testing. */
 }
 
+void engineParallel(struct predicate *predicates[],
+                    struct predicate *splitPredicate, int splitRound,
+                    int numberOfThreads)
+{
+  /* stub for testing. */
+}
+
+struct predicate VennPredicate = {/* stub for testing. */};
+
+void logShareSignatures(int numberOfThreads)
+{
+  /* stub for testing. */
+}
+
+void multiprocessRun(int numberOfProcesses)
+{
+  /* stub for testing. */
+}
+
+void compactExpand(const char *filename, int variationNumber)
+{
+  /* stub for testing. */
+}
+
+void archiveExpand(const char *filename)
+{
+  /* stub for testing. */
+}
+
+void compressExpand(const char *filename)
+{
+  /* stub for testing. */
+}
+
+void writerStart(int numberOfThreads)
+{
+  /* stub for testing. */
+}
+
+void writerStop(void)
+{
+  /* stub for testing. */
+}
+
 char *getBuffer()
 {
   return NULL;
@@ -14,6 +14,7 @@
 #include <unity.h>
 void setUp(void)
 {
+  initializeCycleSets();
   initializeS6();
   initializeStatisticLogging("/dev/stdout", 20, 5);
 }
@@ -40,10 +41,33 @@ static void testCanonical6()
 }
 
 static struct predicate countSolutionsPredicate = {"Count", countSolutions,
-                                                   NULL};
+                                                   NULL, NULL};
 static struct predicate* testProgram[] = {
     &InitializePredicate, &InnerFacePredicate, &countSolutionsPredicate};
 
+static void setCentralFaceDegrees(FACE_DEGREE* degrees)
+{
+  for (int i = 0; i < NCOLORS; i++) {
+    CYCLE cycle = Cycles;
+    while (cycle->length != degrees[i]) {
+      cycle++;
+    }
+    Context.faces[(NFACES - 1) & ~(1u << i)].cycle = cycle;
+  }
+}
+
+static void testPrefixCanonicity()
+{
+  setCentralFaceDegrees(intArray(5, 5, 4, 4, 4, 5));
+  TEST_ASSERT_TRUE(s6PrefixIsNonCanonical());
+  setCentralFaceDegrees(intArray(6, 5, 5, 4, 4, 3));
+  TEST_ASSERT_FALSE(s6PrefixIsNonCanonical());
+  /* Equivocal: the faces without two adjacent colors decide. */
+  setCentralFaceDegrees(intArray(5, 5, 5, 4, 4, 4));
+  TEST_ASSERT_FALSE(s6PrefixIsNonCanonical());
+  memset(Context.faces, 0, sizeof(Context.faces));
+}
+
 static void testCallback()
 {
   count6 = 0;
@@ -51,10 +75,21 @@ static void testCallback()
   TEST_ASSERT_EQUAL(56, count6);
 }
 
+static void testSignatures()
+{
+  FACE_DEGREE signatures[MAX_SIGNATURES][NCOLORS];
+  initialize();
+  TEST_ASSERT_EQUAL(56, innerFaceSignatures(signatures));
+  TEST_ASSERT_EQUAL(6, signatures[0][0]);
+  TEST_ASSERT_NOT_EQUAL(NON_CANONICAL, s6SymmetryType6(signatures[0]));
+}
+
 int main(void)
 {
   UNITY_BEGIN();
   RUN_TEST(testCanonical6);
+  RUN_TEST(testPrefixCanonicity);
   RUN_TEST(testCallback);
+  RUN_TEST(testSignatures);
   return UNITY_END();
 }
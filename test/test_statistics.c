@@ -0,0 +1,99 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "statistics.h"
+#include "utils.h"
+#include "visible_for_testing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+
+/* More than the old fixed limit of the statistics. */
+#define MANY_STATISTICS 200
+
+static uint64 Counters[MANY_STATISTICS];
+static char Names[MANY_STATISTICS][16];
+static char ShortNames[MANY_STATISTICS][8];
+
+void setUp(void)
+{
+  initialize();
+  initializeStatisticLogging("/dev/null", 1000, 1000);
+}
+
+void tearDown(void)
+{
+}
+
+/* The value of the statistic with this short name and name. */
+static uint64 statisticValue(const char* names)
+{
+  char line[256];
+  uint64 count;
+  int length;
+  bool found = false;
+  FILE* file = tmpfile();
+  TEST_ASSERT_NOT_NULL(file);
+  statisticWriteTotals(file);
+  rewind(file);
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (sscanf(line, "#statistic %*d %*d %*d %llu %n", &count, &length) != 1) {
+      continue;
+    }
+    if (strcmp(line + length, names) == 0) {
+      found = true;
+      break;
+    }
+  }
+  fclose(file);
+  TEST_ASSERT_TRUE(found);
+  return count;
+}
+
+static void testManyStatistics(void)
+{
+  for (int i = 0; i < MANY_STATISTICS; i++) {
+    sprintf(Names[i], "Many %d", i);
+    sprintf(ShortNames[i], "m%d", i);
+    Counters[i] = i;
+    statisticIncludeInteger(&Counters[i], ShortNames[i], Names[i], true);
+  }
+  TEST_ASSERT_EQUAL_UINT64(0, statisticValue("m0 Many 0\n"));
+  TEST_ASSERT_EQUAL_UINT64(MANY_STATISTICS - 1,
+                           statisticValue("m199 Many 199\n"));
+}
+
+static void testStatisticStream(void)
+{
+  char filename[] = "/tmp/test_statisticsXXXXXX";
+  char line[1 << 16];
+  static uint64 counter = 42;
+  int fd = mkstemp(filename);
+  FILE* file;
+  TEST_ASSERT_TRUE(fd >= 0);
+  close(fd);
+  statisticIncludeInteger(&counter, "q", "stream \"test\"", false);
+  initializeStatisticStream(filename);
+  statisticPrintFull();
+  file = fopen(filename, "r");
+  TEST_ASSERT_NOT_NULL(file);
+  TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), file));
+  TEST_ASSERT_EQUAL_INT(0, strncmp("{\"time\":", line, 8));
+  TEST_ASSERT_NOT_NULL(strstr(line, ",\"final\":true,"));
+  TEST_ASSERT_NOT_NULL(strstr(line, "\"stream \\\"test\\\"\":42"));
+  TEST_ASSERT_NOT_NULL(strstr(line, "\"No matching cycles\":[0]"));
+  TEST_ASSERT_EQUAL_STRING("}}\n", line + strlen(line) - 3);
+  TEST_ASSERT_NULL(fgets(line, sizeof(line), file));
+  fclose(file);
+  remove(filename);
+}
+
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(testManyStatistics);
+  RUN_TEST(testStatisticStream);
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#include "engine.h"
+#include "statistics.h"
+#include "utils.h"
+#include "visible_for_testing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+/* More than the old fixed size of the trail, and several segments. */
+#define LARGE_TRAIL (1 << 20)
+/* About the largest trail of the six curve search. */
+#define TYPICAL_TRAIL 8000
+#define BENCHMARK_ROUNDS 2000
+
+static uint_trail* Words;
+
+void setUp(void)
+{
+  initialize();
+  Words = calloc(LARGE_TRAIL, sizeof(uint_trail));
+  TEST_ASSERT_NOT_NULL(Words);
+}
+
+void tearDown(void)
+{
+  free(Words);
+}
+
+static void testGrowAndRewind(void)
+{
+  uint32_t i;
+  TRAIL startTrail = Trail;
+  void* pointer = NULL;
+  TRAIL_SET_POINTER(&pointer, Words);
+  for (i = 0; i < LARGE_TRAIL; i++) {
+    trailSetInt(&Words[i], i + 1);
+  }
+  for (i = 0; i < LARGE_TRAIL; i++) {
+    trailMaybeSetInt(&Words[i], i + 1);
+  }
+  TEST_ASSERT_NOT_EQUAL(startTrail, Trail);
+  TEST_ASSERT_EQUAL_UINT64(LARGE_TRAIL, Words[LARGE_TRAIL - 1]);
+  TEST_ASSERT_TRUE(trailRewindTo(startTrail));
+  TEST_ASSERT_EQUAL(startTrail, Trail);
+  TEST_ASSERT_NULL(pointer);
+  for (i = 0; i < LARGE_TRAIL; i++) {
+    TEST_ASSERT_EQUAL_UINT64(0, Words[i]);
+  }
+  TEST_ASSERT_FALSE(trailRewindTo(startTrail));
+}
+
+static void testSetIntOnce(void)
+{
+  uint64 stamp = 0;
+  TRAIL outer = trailBacktrackPoint();
+  TRAIL inner, afterOne;
+  trailSetIntOnce(&Words[0], 1, &stamp);
+  afterOne = Trail;
+  trailSetIntOnce(&Words[0], 2, &stamp);
+  TEST_ASSERT_EQUAL(afterOne, Trail);
+  inner = trailBacktrackPoint();
+  trailSetIntOnce(&Words[0], 3, &stamp);
+  TEST_ASSERT_NOT_EQUAL(afterOne, Trail);
+  trailSetIntOnce(&Words[0], 4, &stamp);
+  trailRewindTo(inner);
+  TEST_ASSERT_EQUAL_UINT64(2, Words[0]);
+  trailSetIntOnce(&Words[0], 5, &stamp);
+  trailRewindTo(inner);
+  TEST_ASSERT_EQUAL_UINT64(2, Words[0]);
+  trailRewindTo(outer);
+  TEST_ASSERT_EQUAL_UINT64(0, Words[0]);
+}
+
+static PredicateResult tryGrow(int round)
+{
+  (void)round;
+  for (uint32_t i = 0; i < 100; i++) {
+    trailSetInt(&Words[i], i + 1);
+  }
+  return PredicateSuccessNextPredicate;
+}
+
+/* The value of the statistic with this short name and name. */
+static uint64 statisticValue(const char* names)
+{
+  char line[256];
+  uint64 count;
+  int length;
+  bool found = false;
+  FILE* file = tmpfile();
+  TEST_ASSERT_NOT_NULL(file);
+  statisticWriteTotals(file);
+  rewind(file);
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (sscanf(line, "#statistic %*d %*d %*d %llu %n", &count, &length) != 1) {
+      continue;
+    }
+    if (strcmp(line + length, names) == 0) {
+      found = true;
+      break;
+    }
+  }
+  fclose(file);
+  TEST_ASSERT_TRUE(found);
+  return count;
+}
+
+static void testMaxTrailPerPredicate(void)
+{
+  TRAIL startTrail = Trail;
+  engine((PREDICATE[]){&(struct predicate){"Grow", tryGrow, NULL, NULL},
+                       &FAILPredicate});
+  trailRewindTo(startTrail);
+  TEST_ASSERT_TRUE(statisticValue("$Grow MaxTrail Grow\n") >= 100);
+}
+
+static PredicateResult tryPorts(int round)
+{
+  (void)round;
+  return predicateChoices(3);
+}
+
+static PredicateResult retryPorts(int round, int choice)
+{
+  (void)round;
+  return choice == 1 ? PredicateFail : PredicateSuccessNextPredicate;
+}
+
+static void testPortsPerPredicate(void)
+{
+  engine((PREDICATE[]){&(struct predicate){"Ports", tryPorts, retryPorts, NULL},
+                       &FAILPredicate});
+  TEST_ASSERT_EQUAL_UINT64(1, statisticValue("cPorts Calls Ports\n"));
+  TEST_ASSERT_EQUAL_UINT64(3, statisticValue("rPorts Retries Ports\n"));
+  TEST_ASSERT_EQUAL_UINT64(1, statisticValue("fPorts Fails Ports\n"));
+  TEST_ASSERT_TRUE(statisticValue("tPorts Cycles Ports\n") > 0);
+}
+
+static double nanosecondsSince(struct timespec* start, uint64 operations)
+{
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return ((end.tv_sec - start->tv_sec) * 1e9 +
+          (end.tv_nsec - start->tv_nsec)) /
+         operations;
+}
+
+/* Prints the time per entry to fill and to rewind a typical trail; only
+ * run by make benchmarks. */
+static void testBenchmarkTrail(void)
+{
+  uint32_t i, round;
+  double setTime = 0.0, rewindTime = 0.0;
+  struct timespec start;
+  TRAIL startTrail = Trail;
+  for (round = 0; round < BENCHMARK_ROUNDS; round++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < TYPICAL_TRAIL; i++) {
+      trailSetInt(&Words[i], round + i);
+    }
+    setTime += nanosecondsSince(&start, TYPICAL_TRAIL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    trailRewindTo(startTrail);
+    rewindTime += nanosecondsSince(&start, TYPICAL_TRAIL);
+  }
+  printf("trailSetInt %5.2fns trailRewindTo %5.2fns per entry\n",
+         setTime / BENCHMARK_ROUNDS, rewindTime / BENCHMARK_ROUNDS);
+  TEST_ASSERT_EQUAL_UINT64(0, Words[TYPICAL_TRAIL - 1]);
+}
+
+int main(int argc, char* argv[])
+{
+  UNITY_BEGIN();
+  if (argc > 1 && strcmp(argv[1], "benchmark") == 0) {
+    RUN_TEST(testBenchmarkTrail);
+    return UNITY_END();
+  }
+  RUN_TEST(testGrowAndRewind);
+  RUN_TEST(testSetIntOnce);
+  RUN_TEST(testMaxTrailPerPredicate);
+  RUN_TEST(testPortsPerPredicate);
+  return UNITY_END();
+}
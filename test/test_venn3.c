@@ -48,11 +48,11 @@ static void verifyFaceSize(int size)
 {
   int i;
   for (i = 0; i < NFACES; i++) {
-    TEST_ASSERT_EQUAL(size, Faces[i].cycleSetSize);
+    TEST_ASSERT_EQUAL(size, Context.faces[i].cycleSetSize);
     if (size == 1) {
-      TEST_ASSERT_NOT_NULL(Faces[i].cycle);
+      TEST_ASSERT_NOT_NULL(Context.faces[i].cycle);
     } else {
-      TEST_ASSERT_NULL(Faces[i].cycle);
+      TEST_ASSERT_NULL(Context.faces[i].cycle);
     }
   }
 }
@@ -98,7 +98,7 @@ static void checkBVertexOfAEdge(FACE face, EDGE edge, bool primary,
 {
   TEST_ASSERT_EQUAL(primary, IS_CLOCKWISE_EDGE(edge));
   TEST_ASSERT_EQUAL(face->colors, edge->colors);
-  TEST_ASSERT_NULL(edge->to);
+  TEST_ASSERT_NULL(EDGE_TO(edge));
   TEST_ASSERT_EQUAL(A, edge->color);
   TEST_ASSERT_NULL(edge->possiblyTo[A].vertex);
   TEST_ASSERT_NULL(edge->possiblyTo[A].next);
@@ -144,7 +144,7 @@ static void testChoosingAndBacktracking()
 {
   int i;
   FACE face;
-  TRAIL startTrail = Trail;
+  TRAIL startTrail = trailBacktrackPoint();
   // For each face in turn, we can guess that is cycle is acb (the first one of
   // the two cycles),
   for (i = 0; i < NFACES; i++) {
@@ -152,13 +152,13 @@ static void testChoosingAndBacktracking()
     TEST_ASSERT_EQUAL(startTrail, Trail);
     verifyFaceSize(2);
     face = Faces + i;
-    face->cycle = Cycles;
+    FACE_STATE(face)->cycle = Cycles;
     TEST_ASSERT_NULL(dynamicFaceBacktrackableChoice(face));
     // Having selected one face, all of the other faces are determined.
     verifyFaceSize(1);
     TEST_ASSERT_EQUAL(7, CycleForcedCounter);
     trailRewindTo(startTrail);
-    face->cycle = NULL;
+    FACE_STATE(face)->cycle = NULL;
   }
   // There are 8 faces, so 8 guesses.
   TEST_ASSERT_EQUAL(8, CycleGuessCounterIPC);
@@ -175,7 +175,7 @@ static struct predicateResult foundSolution()
 static void testSearch()
 {
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(2, SolutionCount);
   TEST_ASSERT_EQUAL(14, CycleForcedCounter);
 }
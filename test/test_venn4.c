@@ -34,7 +34,7 @@ static struct predicateResult foundSolution()
 static void testSearch()
 {
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(FACTORIAL4, SolutionCount);
 }
 
@@ -43,7 +43,7 @@ static void testSearchAbcd()
   SolutionCount = 0;
   dynamicFaceSetupCentral(intArray(0, 0, 0, 0));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(4, SolutionCount);
 }
 
@@ -52,7 +52,7 @@ static void testSearch4343()
   SolutionCount = 0;
   dynamicFaceSetupCentral(intArray(4, 3, 4, 3));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(0, SolutionCount);
 }
 
@@ -61,7 +61,7 @@ static void testSearch4433()
   SolutionCount = 0;
   dynamicFaceSetupCentral(intArray(4, 4, 3, 3));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(1, SolutionCount);
 }
 
@@ -50,8 +50,9 @@ static struct predicateResult countSolutions()
 
 static struct predicateResult invertSolution()
 {
-  CYCLE_ID cycleId = s6PermuteCycleId(Faces[0].cycle - Cycles,
-                                      s6Automorphism(Faces[0].cycle - Cycles));
+  CYCLE_ID outerCycleId = Context.faces[0].cycle - Cycles;
+  CYCLE_ID cycleId =
+      s6PermuteCycleId(outerCycleId, s6Automorphism(outerCycleId));
   SIGNATURE signature = s6SignatureFromFaces();
   SIGNATURE maxSignature = s6MaxSignature();
   TEST_ASSERT_EQUAL(NCYCLES - 1, cycleId);
@@ -140,7 +141,7 @@ static void testSearchAbcde()
   MatchABCDE = 0;
   dynamicFaceSetupCentral(intArray(0, 0, 0, 0, 0));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL}});
+      &VennPredicate, &(struct predicate){"Found", foundSolution, NULL, NULL}});
   TEST_ASSERT_EQUAL(152, SolutionCount);
   TEST_ASSERT_EQUAL(40, MatchingSolutions);
   // 4 actual solutions, times 5 rotations times 2 reflections.
@@ -157,7 +158,8 @@ static void testSearch44444()
   CanonicalCount = 0;
   dynamicFaceSetupCentral(intArray(4, 4, 4, 4, 4));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(2, SolutionCount);
   TEST_ASSERT_EQUAL(2, EquivocalCount);
   TEST_ASSERT_EQUAL(0, CanonicalCount);
@@ -170,7 +172,8 @@ static void testSearch55433()
   CanonicalCount = 0;
   dynamicFaceSetupCentral(intArray(5, 5, 4, 3, 3));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(6, SolutionCount);
   TEST_ASSERT_EQUAL(0, EquivocalCount);
   TEST_ASSERT_EQUAL(6, CanonicalCount);
@@ -183,7 +186,8 @@ static void testSearch55343()
   CanonicalCount = 0;
   dynamicFaceSetupCentral(intArray(5, 5, 3, 4, 3));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(0, SolutionCount);
   TEST_ASSERT_EQUAL(0, EquivocalCount);
   TEST_ASSERT_EQUAL(0, CanonicalCount);
@@ -196,7 +200,8 @@ static void testSearch54443()
   CanonicalCount = 0;
   dynamicFaceSetupCentral(intArray(5, 4, 4, 4, 3));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(4, SolutionCount);
   TEST_ASSERT_EQUAL(0, EquivocalCount);
   TEST_ASSERT_EQUAL(4, CanonicalCount);
@@ -209,7 +214,8 @@ static void testSearch54434()
   CanonicalCount = 0;
   dynamicFaceSetupCentral(intArray(5, 4, 4, 3, 4));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(5, SolutionCount);
   TEST_ASSERT_EQUAL(0, EquivocalCount);
   TEST_ASSERT_EQUAL(5, CanonicalCount);
@@ -220,7 +226,8 @@ static void testInvert()
   dynamicFaceSetupCentral(intArray(5, 4, 4, 3, 4));
   dynamicFaceSetCycleLength(1 << 2, 3);
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", invertSolution, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", invertSolution, NULL, NULL}});
 }
 int main(void)
 {
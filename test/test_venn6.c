@@ -1,15 +1,25 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#define _GNU_SOURCE
+#include "checkpoint.h"
+#include "common.h"
 #include "engine.h"
 #include "face.h"
 #include "helper_for_tests.h"
+#include "main.h"
+#include "nogood.h"
+#include "nondeterminism.h"
 #include "predicates.h"
+#include "profile.h"
 #include "s6.h"
 #include "statistics.h"
 #include "utils.h"
+#include "visible_for_testing.h"
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 #include <unity.h>
 
 void setUp(void)
@@ -23,6 +33,7 @@ void tearDown(void)
   engineResume((PREDICATE[]){&FAILPredicate});
 }
 static int SolutionCount = 0;
+static uint64 BestSolutionGuesses = 0;
 
 static struct predicateResult countSolutions(int round)
 {
@@ -44,11 +55,232 @@ static void testCentralFaceEdge(void)
 
 static void testSearchForBestSolution()
 {
+  uint64 guesses = CycleGuessCounterIPC;
   SolutionCount = 0;
   dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(80, SolutionCount);
+  BestSolutionGuesses = CycleGuessCounterIPC - guesses;
+}
+
+#define CHECKPOINT_SOLUTION 30
+static int CheckpointAt = 0;
+static char CheckpointFilename[] = "/tmp/test_checkpointXXXXXX";
+static uint64 GuessesAtEnd = 0;
+static uint64 SolutionsAtEnd = 0;
+
+/* Like countSolutions, but writes a checkpoint at solution CheckpointAt. */
+static struct predicateResult checkpointSolutions(int round)
+{
+  (void)round;
+  if (++SolutionCount == CheckpointAt) {
+    checkpointWrite(CheckpointFilename);
+  }
+  return PredicateFail;
+}
+
+static void testCheckpoint()
+{
+  int fd = mkstemp(CheckpointFilename);
+  TEST_ASSERT_NOT_EQUAL(-1, fd);
+  close(fd);
+  SolutionCount = 0;
+  CheckpointAt = CHECKPOINT_SOLUTION;
+  dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+  engineResume((PREDICATE[]){
+      &VennPredicate,
+      &(struct predicate){"Checkpoint", checkpointSolutions, NULL, NULL}});
+  TEST_ASSERT_EQUAL(80, SolutionCount);
+  GuessesAtEnd = CycleGuessCounterIPC;
+  SolutionsAtEnd = GlobalSolutionsFoundIPC;
+}
+
+/* The checkpoint was written in a call of the Checkpoint predicate, which
+ * is made again on resuming. */
+static void testResume()
+{
+  SolutionCount = 0;
+  CheckpointAt = 0;
+  CycleGuessCounterIPC = 0;
+  GlobalSolutionsFoundIPC = 0;
+  TEST_ASSERT_TRUE(checkpointResume(CheckpointFilename));
+  dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+  engineResume((PREDICATE[]){
+      &VennPredicate,
+      &(struct predicate){"Checkpoint", checkpointSolutions, NULL, NULL}});
+  checkpointFinish(CheckpointFilename);
+  TEST_ASSERT_EQUAL(80 - CHECKPOINT_SOLUTION + 1, SolutionCount);
+  TEST_ASSERT_EQUAL(GuessesAtEnd, CycleGuessCounterIPC);
+  TEST_ASSERT_EQUAL(SolutionsAtEnd, GlobalSolutionsFoundIPC);
+  TEST_ASSERT_FALSE(checkpointResume(CheckpointFilename));
+}
+
+/* A run of the -C program, for 555444, in a thread of its own, so that its
+ * counters are included from scratch, as in a new process. */
+struct countRun {
+  bool resume;
+  int threads;
+  bool resumed;
+  char totals[1 << 14];
+};
+
+static void* countRun(void* arg)
+{
+  struct countRun* run = arg;
+  FILE* file = fmemopen(run->totals, sizeof(run->totals), "w");
+  run->resumed = run->resume && checkpointResume(CheckpointFilename);
+  if (run->threads > 1) {
+    engineParallel(NonDeterministicCountProgram, &VennPredicate, 5,
+                   run->threads);
+  } else {
+    engine(NonDeterministicCountProgram);
+  }
+  statisticWriteTotals(file);
+  fclose(file);
+  return NULL;
+}
+
+static void runCount(struct countRun* run)
+{
+  pthread_t thread;
+  TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, countRun, run));
+  pthread_join(thread, NULL);
+}
+
+/* Every counter of expected is in actual, except the time and the high
+ * water marks. */
+static void assertSameCounters(char* expected, const char* actual)
+{
+  char* copy = strdup(expected);
+  for (char* line = strtok(copy, "\n"); line != NULL;
+       line = strtok(NULL, "\n")) {
+    if (strncmp(line, "#statistic 0 ", 13) == 0 &&
+        strstr(line, " Cycles ") == NULL) {
+      TEST_ASSERT_MESSAGE(strstr(actual, line) != NULL, line);
+    }
+  }
+  free(copy);
+}
+
+/* The checkpoint is written from the Venn predicate, so the resumed run
+ * only includes the counters of the later predicates, such as the calls of
+ * Count, after the checkpoint is restored. */
+static void testResumeCountProgram()
+{
+  static struct countRun whole = {false, 1, false, ""};
+  static struct countRun resumed = {true, 1, false, ""};
+  memcpy(CentralFaceDegreesFlag, intArray(5, 5, 5, 4, 4, 4),
+         sizeof(CentralFaceDegreesFlag));
+  CheckpointFileFlag = CheckpointFilename;
+  CheckpointSeconds = 0;
+  runCount(&whole);
+  CheckpointFileFlag = NULL;
+  CheckpointSeconds = 60;
+  runCount(&resumed);
+  checkpointFinish(CheckpointFilename);
+  memset(CentralFaceDegreesFlag, 0, sizeof(CentralFaceDegreesFlag));
+  TEST_ASSERT_TRUE(resumed.resumed);
+  TEST_ASSERT_NOT_NULL(strstr(whole.totals, " Calls Count\n"));
+  assertSameCounters(whole.totals, resumed.totals);
+}
+
+/* The threads share out round 5 of Venn, but all do the rounds before. */
+static void testParallelCountProgram()
+{
+  static struct countRun serial = {false, 1, false, ""};
+  static struct countRun parallel = {false, 3, false, ""};
+  memcpy(CentralFaceDegreesFlag, intArray(5, 5, 5, 4, 4, 4),
+         sizeof(CentralFaceDegreesFlag));
+  runCount(&serial);
+  runCount(&parallel);
+  memset(CentralFaceDegreesFlag, 0, sizeof(CentralFaceDegreesFlag));
+  TEST_ASSERT_NOT_NULL(strstr(parallel.totals, " guesses\n"));
+  assertSameCounters(serial.totals, parallel.totals);
+}
+
+/* The engine stack of setUp has two entries, so this is round 3 of Venn. */
+#define SPLIT_DEPTH 5
+#define MAX_SUBTREES 1024
+static struct choicePoint Subtrees[MAX_SUBTREES][SPLIT_DEPTH + 1];
+static int NumberOfSubtrees = 0;
+
+static void recordSubtree(void)
+{
+  struct choicePoint path[MAX_STACK_SIZE];
+  TEST_ASSERT_EQUAL(SPLIT_DEPTH + 1, enginePath(path));
+  TEST_ASSERT_LESS_THAN(MAX_SUBTREES, NumberOfSubtrees);
+  memcpy(Subtrees[NumberOfSubtrees++], path, sizeof(Subtrees[0]));
+}
+
+static void testSplitIntoSubtrees()
+{
+  int solutions = 0;
+  SolutionCount = 0;
+  NumberOfSubtrees = 0;
+  engineStopAt(SPLIT_DEPTH, recordSubtree);
+  dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+  engineResume((PREDICATE[]){
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
+  engineStopAt(-1, NULL);
+  TEST_ASSERT_EQUAL(0, SolutionCount);
+  TEST_ASSERT_GREATER_THAN(1, NumberOfSubtrees);
+  for (int i = 0; i < NumberOfSubtrees; i++) {
+    tearDown();
+    setUp();
+    SolutionCount = 0;
+    engineSubtree(Subtrees[i], SPLIT_DEPTH + 1);
+    dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+    engineResume((PREDICATE[]){
+        &VennPredicate,
+        &(struct predicate){"Found", countSolutions, NULL, NULL}});
+    solutions += SolutionCount;
+  }
+  TEST_ASSERT_EQUAL(80, solutions);
+}
+
+static void testSearchWithNogoods()
+{
+  uint64 guesses = CycleGuessCounterIPC;
+  SolutionCount = 0;
+  NogoodsFlag = true;
+  dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+  engineResume((PREDICATE[]){
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
+  NogoodsFlag = false;
+  TEST_ASSERT_EQUAL(80, SolutionCount);
+  TEST_ASSERT_GREATER_THAN(0, NogoodHitCounter);
+  TEST_ASSERT_EQUAL(CycleGuessCounterIPC - guesses + NogoodHitCounter,
+                    BestSolutionGuesses);
+}
+
+/* Each node of the Venn predicate has at least one choice. */
+static void testProfile()
+{
+  FAILURE nodes, choices;
+  uint64 totalNodes = 0;
+  SolutionCount = 0;
+  ProfileFlag = true;
+  initializeProfile();
+  dynamicFaceSetupCentral(intArray(5, 5, 5, 4, 4, 4));
+  engineResume((PREDICATE[]){
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
+  ProfileFlag = false;
+  TEST_ASSERT_EQUAL(80, SolutionCount);
+  nodes = statisticFindFailure("Nodes by round");
+  choices = statisticFindFailure("Choices by round");
+  TEST_ASSERT_NOT_NULL(nodes);
+  TEST_ASSERT_NOT_NULL(choices);
+  TEST_ASSERT_EQUAL(1, nodes->count[0]);
+  for (int i = 0; i < NFACES; i++) {
+    TEST_ASSERT_TRUE(choices->count[i] >= nodes->count[i]);
+    totalNodes += nodes->count[i];
+  }
+  TEST_ASSERT_GREATER_THAN(1, totalNodes);
 }
 
 static void testSearchForTwoSolutions()
@@ -68,7 +300,8 @@ static void testSearchForTwoSolutions()
   dynamicFaceAddSpecific("f", "aefdc");
   */
   engineResume((PREDICATE[]){
-      &VennPredicate, &(struct predicate){"Found", countSolutions, NULL}});
+      &VennPredicate,
+      &(struct predicate){"Found", countSolutions, NULL, NULL}});
 
   TEST_ASSERT_EQUAL(2, SolutionCount);
 }
@@ -79,16 +312,36 @@ static void testFullSearch(void)
   SolutionCount = 0;
   engineResume(
       (PREDICATE[]){&InnerFacePredicate, &LogPredicate, &VennPredicate,
-                    &(struct predicate){"Found", countSolutions, NULL}});
+                    &(struct predicate){"Found", countSolutions, NULL, NULL}});
   TEST_ASSERT_EQUAL(233, SolutionCount);
 }
 
+static void testParallelFullSearch(void)
+{
+  uint64 solutions = GlobalSolutionsFoundIPC;
+  uint64 guesses = CycleGuessCounterIPC;
+  engineParallel((PREDICATE[]){&InitializePredicate, &InnerFacePredicate,
+                               &VennPredicate, &FAILPredicate},
+                 &VennPredicate, 5, 3);
+  TEST_ASSERT_EQUAL(233, GlobalSolutionsFoundIPC - solutions);
+  TEST_ASSERT_EQUAL(2022014, CycleGuessCounterIPC - guesses);
+}
+
 int main(void)
 {
   UNITY_BEGIN();
   RUN_TEST(testCentralFaceEdge);
   RUN_TEST(testSearchForBestSolution);
+  RUN_TEST(testCheckpoint);
+  RUN_TEST(testResume);
+  RUN_TEST(testResumeCountProgram);
+  RUN_TEST(testSplitIntoSubtrees);
+  RUN_TEST(testSearchWithNogoods);
+  RUN_TEST(testProfile);
   RUN_TEST(testSearchForTwoSolutions);
   RUN_TEST(testFullSearch);
+  RUN_TEST(testParallelFullSearch);
+  /* After testParallelFullSearch, which counts in this thread. */
+  RUN_TEST(testParallelCountProgram);
   return UNITY_END();
 }
@@ -26,6 +26,20 @@ extern void trailMaybeSetInt(
 extern void trailSetPointer(void **ptr,
                             void *value); /* Set a pointer with backtracking */
 
+/*
+ * Like trailSetInt, but the old value is only put on the trail the first
+ * time ptr is set since the last backtrack point. *stamp, which is not on
+ * the trail, records when that was.
+ */
+extern void trailSetIntOnce(uint_trail *ptr, uint_trail value, uint64 *stamp);
+
+/*
+ * The current end of the trail, to pass to trailRewindTo later. Use this,
+ * rather than reading Trail, so that trailSetIntOnce trails every value
+ * set after it.
+ */
+extern TRAIL trailBacktrackPoint(void);
+
 /* Helper macro for type-safe pointer setting */
 #define TRAIL_SET_POINTER(a, b) trailSetPointer((void **)a, b)
 
@@ -2,6 +2,7 @@
 
 #include "triangles.h"
 
+#include "context.h"
 #include "edge.h"
 #include "trail.h"
 #include "utils.h"
@@ -27,12 +28,12 @@ static int edgeIsCorner(EDGE edge, EDGE (*corners)[3])
 static void dynamicCheckRegularEdge(void *data, EDGE current, int line)
 {
   LineCrossingData *lcd = (LineCrossingData *)data;
-  VERTEX vertex = current->to->vertex;
+  VERTEX vertex = EDGE_TO(current)->vertex;
 
-  if (vertex->lineId == 0) {
-    trailSetInt(&vertex->lineId, 1 + current->color * 3 + line);
+  if (VERTEX_LINE_ID(vertex) == 0) {
+    trailSetInt(&VERTEX_LINE_ID(vertex), 1 + current->color * 3 + line);
   } else {
-    uint64 crossedLineAsBit = 1l << vertex->lineId;
+    uint64 crossedLineAsBit = 1l << VERTEX_LINE_ID(vertex);
     if (lcd->linesCrossed & crossedLineAsBit) {
       lcd->linesAreCrossed = true;
     } else {
@@ -144,7 +145,7 @@ void triangleTraverse(COLOR color, EDGE (*corners)[3],
     }
 
     if (callbacks->processVertex) {
-      callbacks->processVertex(data, current->to->vertex, color);
+      callbacks->processVertex(data, EDGE_TO(current)->vertex, color);
     }
   }
 
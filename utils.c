@@ -4,17 +4,43 @@
 
 #include <sys/stat.h>
 
+#include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
-#define USAGE_ONE_LINE                                                   \
-  "Usage: %s -f outputFolder [-d centralFaceDegrees] [-m maxSolutions] " \
-  "[-n maxVariantsPerSolution] [-k skipFirstSolutions] [-j "             \
-  "skipFirstVariantsPerSolution] [-v]\n"
+#define USAGE_ONE_LINE                                                    \
+  "Usage: %s -f outputFolder [-d centralFaceDegrees] [-m maxSolutions] "  \
+  "[-n maxVariantsPerSolution] [-k skipFirstSolutions] [-j "              \
+  "skipFirstVariantsPerSolution] [-T threads [-R round]] [-P processes] " \
+  "[-c | -a | -z | -w writers] [-r checkpointFile | -s address | "        \
+  "-S depth] [-J statisticsFile] [-p] [-v]\n"                             \
+  "   or: %s -C [-d centralFaceDegrees] [-T threads [-R round] | "        \
+  "-P processes | -r checkpointFile | -s address | -S depth] "            \
+  "[-J statisticsFile] [-p]\n"                                            \
+  "   or: %s -e probes [-d centralFaceDegrees]\n"                         \
+  "   or: %s -x solution.var|solution.gma|solution.gmz\n"
 
 #define USAGE_WITH_D_EXPLANATION                                              \
   "When -d is specified, -m and -k apply to solutions with that face degree " \
   "pattern.\n"                                                                \
-  "Otherwise, they apply globally across all face degree patterns.\n"         \
+  "Otherwise, they apply globally across all face degree patterns,\n"         \
+  "and cannot be combined with -T or -P.\n"                                   \
+  "Use -c to write the variations of each solution to one .var file,\n"       \
+  "or -a to write their GraphML to one .gma archive file,\n"                  \
+  "or -z to write their GraphML to one compressed .gmz file,\n"               \
+  "which -x expands back to the GraphML files.\n"                             \
+  "Use -R, with -T, to share out the search from that round of the Venn\n"    \
+  "predicate (default 5), or, with -R 0, by face degree pattern.\n"           \
+  "Use -w to write the GraphML files with that many writer threads.\n"        \
+  "Use -C to count the variations of each solution, writing no files.\n"      \
+  "Use -e to estimate the size of each search, from that many probes.\n"      \
+  "Use -r to checkpoint the search to that file every minute, and, if it\n"   \
+  "exists, to resume the search from it.\n"                                   \
+  "Use -S to print the address of each call at that depth of the search,\n"   \
+  "and -s, with one of them and the same other options, to search only\n"     \
+  "below it.\n"                                                               \
+  "Use -J to write the statistics to that file as JSON lines, about once\n"   \
+  "a second, e.g. -J /dev/fd/3.\n"                                            \
+  "Use -p to profile the time and the nodes at each depth of the search.\n"   \
   "Use -v to enable verbose output mode.\n"
 
 /**
@@ -28,7 +54,8 @@ void initializeFolder(const char *folder)
 
   if (stat(folder, &st) == -1) {
     /* Directory does not exist, create it */
-    if (mkdir(folder, 0700) != 0) {
+    /* Another writer thread may have just created it. */
+    if (mkdir(folder, 0700) != 0 && errno != EEXIST) {
       perror("Failed to create directory");
       exit(EXIT_FAILURE);
     }
@@ -47,7 +74,8 @@ void initializeFolder(const char *folder)
  */
 void disaster(const char *programName, const char *message)
 {
-  fprintf(stderr, USAGE_ONE_LINE, programName);
+  fprintf(stderr, USAGE_ONE_LINE, programName, programName, programName,
+          programName);
   fprintf(stderr, USAGE_WITH_D_EXPLANATION);
   fprintf(stderr, "%s\n", message);
   exit(EXIT_FAILURE);
@@ -1,19 +1,22 @@
 /* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
 
+#include "checkpoint.h"
 #include "common.h"
 #include "face.h"
 #include "failure.h"
 #include "main.h"
+#include "nogood.h"
 #include "predicates.h"
+#include "profile.h"
 #include "s6.h"
 #include "statistics.h"
 #include "utils.h"
 #include "visible_for_testing.h"
 
-uint64 CycleGuessCounterIPC = 0;
-uint64 GlobalSolutionsFoundIPC = 0;
+THREAD_LOCAL uint64 CycleGuessCounterIPC = 0;
+THREAD_LOCAL uint64 GlobalSolutionsFoundIPC = 0;
 
-static FACE facesInOrderOfChoice[NFACES];
+static THREAD_LOCAL FACE facesInOrderOfChoice[NFACES];
 
 static void dynamicSetFaceCycleSetToSingleton(FACE face, uint64 cycleId)
 {
@@ -22,9 +25,9 @@ static void dynamicSetFaceCycleSetToSingleton(FACE face, uint64 cycleId)
   memset(cycleSet, 0, sizeof(cycleSet));
   cycleSetAdd(cycleId, cycleSet);
   for (i = 0; i < CYCLESET_LENGTH; i++) {
-    trailMaybeSetInt(&face->possibleCycles[i], cycleSet[i]);
+    trailMaybeSetInt(&FACE_STATE(face)->possibleCycles[i], cycleSet[i]);
   }
-  trailMaybeSetInt(&face->cycleSetSize, 1);
+  trailMaybeSetInt(&FACE_STATE(face)->cycleSetSize, 1);
 }
 
 static FAILURE dynamicCheckFacePoints(FACE face, CYCLE cycle, int depth)
@@ -99,7 +102,7 @@ static FAILURE dynamicPropagateRestrictionsToNonVertexAdjacentFaces(FACE face,
     for (j = i + 1; j < NCOLORS; j++) {
       if (COLORSET_HAS_MEMBER(i, cycle->colors) &&
           COLORSET_HAS_MEMBER(j, cycle->colors)) {
-        if (cycleContainsAthenB(face->cycle, i, j)) {
+        if (cycleContainsAthenB(FACE_STATE(face)->cycle, i, j)) {
           continue;
         }
       }
@@ -113,73 +116,133 @@ static FAILURE dynamicPropagateRestrictionsToNonVertexAdjacentFaces(FACE face,
 
 static CYCLE chooseCycle(FACE face, CYCLE cycle)
 {
-  return cycleSetNext(face->possibleCycles, cycle);
+  return cycleSetNext(FACE_STATE(face)->possibleCycles, cycle);
 }
 
 static struct predicateResult dynamicTryFace(int round)
 {
+  if (CheckpointFileFlag != NULL) {
+    checkpointMaybeWrite();
+  }
+  if (StatisticsStreamFlag != NULL) {
+    statisticStreamMaybeWrite();
+  }
   if (round == 0) {
     PerFaceDegreeSolutionNumberIPC = 0;
 #if NCOLORS > 4
     dynamicFaceSetupCentral(CentralFaceDegreesFlag);
 #endif
+    if (NogoodsFlag) {
+      nogoodStartSearch();
+    }
   }
   if ((int64_t)GlobalSolutionsFoundIPC >= GlobalMaxSolutionsFlag) {
     return PredicateFail;
   }
+#if NCOLORS == 6
+  /* Rather than waiting for dynamicFaceFinalCorrectnessChecks. */
+  if (s6PrefixIsNonCanonical()) {
+    failureNonCanonical();
+    return PredicateFail;
+  }
+#endif
   facesInOrderOfChoice[round] = searchChooseNextFace();
   if (facesInOrderOfChoice[round] == NULL) {
     if (dynamicFaceFinalCorrectnessChecks() == NULL) {
       GlobalSolutionsFoundIPC++;
-      PerFaceDegreeSolutionNumberIPC++;
+      if (engineWaitForEarlierTasks()) {
+        PerFaceDegreeSolutionNumberIPC = logNumberSolution();
+      } else {
+        PerFaceDegreeSolutionNumberIPC++;
+      }
       return PredicateSuccessNextPredicate;
     } else {
       return PredicateFail;
     }
   }
-  return predicateChoices(facesInOrderOfChoice[round]->cycleSetSize + 1);
+  if (ProfileFlag) {
+    profileNode(round, FACE_STATE(facesInOrderOfChoice[round])->cycleSetSize);
+  }
+  return predicateChoices(
+      FACE_STATE(facesInOrderOfChoice[round])->cycleSetSize + 1);
 }
 
 static struct predicateResult dynamicRetryFace(int round, int choice)
 {
   (void)choice;
   FACE face = facesInOrderOfChoice[round];
+  struct faceState* state = FACE_STATE(face);
   // Not on trail, otherwise it would get unset before the next retry.
-  face->cycle = chooseCycle(face, face->cycle);
-  if (face->cycle == NULL) {
+  state->cycle = chooseCycle(face, state->cycle);
+  if (state->cycle == NULL) {
+    return PredicateFail;
+  }
+  if (NogoodsFlag && nogoodViolated(face, state->cycle)) {
     return PredicateFail;
   }
   if (dynamicFaceBacktrackableChoice(face) == NULL) {
     return PredicateSuccessSamePredicate;
   }
+  if (NogoodsFlag) {
+    nogoodLearn(face, state->cycle,
+                round == 0 ? NULL : facesInOrderOfChoice[round - 1]);
+  }
   return PredicateFail;
 }
 
-FAILURE dynamicFaceChoice(FACE face, int depth)
+/*
+ * The faces whose cycles have been chosen or forced, but whose consequences
+ * have not yet been propagated. Rather than recursing into each forced
+ * face, as soon as its cycle is known, the faces are appended here, and
+ * processed in turn by dynamicFacePropagate. Propagated counts the faces
+ * that have been processed: first their vertices, curves and corners are
+ * checked, and then the restrictions that depend only on their cycle are
+ * applied to the faces around them, as in the recursion. Making all the
+ * pending restrictions first, and only then the checks, forced more faces
+ * before each failure, and took longer.
+ *
+ * A face is appended only when its cycle is set, which happens at most once
+ * in each choice, so NFACES entries suffice, and the stack stays flat
+ * however long the chain of forced faces is. The list is always emptied
+ * before the choice returns, so it does not need to be on the trail.
+ */
+static THREAD_LOCAL struct {
+  FACE face;
+  int depth;
+} Pending[NFACES];
+static THREAD_LOCAL uint32_t PendingLength = 0;
+static THREAD_LOCAL uint32_t Propagated = 0;
+
+void dynamicFaceChoice(FACE face, int depth)
 {
-  CYCLE cycle = face->cycle;
+  assert(depth <= NFACES);
+  assert(PendingLength < NFACES);
+  Pending[PendingLength].face = face;
+  Pending[PendingLength].depth = depth;
+  PendingLength++;
+}
+
+static FAILURE dynamicFaceRestrictNeighbors(FACE face, int depth)
+{
+  struct faceState* state = FACE_STATE(face);
+  CYCLE cycle = state->cycle;
   uint64 cycleId = cycle - Cycles;
   FAILURE failure;
 
-  assert(depth <= NFACES);
-
-  CHECK_FAILURE(dynamicCheckFacePoints(face, cycle, depth));
-  CHECK_FAILURE(dynamicCheckEdgeCurvesAndCorners(face, cycle, depth));
-  CHECK_FAILURE(dynamicPropagateFaceChoices(face, cycle, depth));
   CHECK_FAILURE(
       dynamicPropagateRestrictionsToNonAdjacentFaces(face, cycle, depth));
 
   if (face->colors == 0 || face->colors == (NFACES - 1)) {
-    TRAIL_SET_POINTER(&face->next, face);
-    TRAIL_SET_POINTER(&face->previous, face);
+    TRAIL_SET_POINTER(&state->next, face);
+    TRAIL_SET_POINTER(&state->previous, face);
   } else {
-    TRAIL_SET_POINTER(&face->next, face->nextByCycleId[cycleId]);
-    TRAIL_SET_POINTER(&face->previous, face->previousByCycleId[cycleId]);
+    TRAIL_SET_POINTER(&state->next, face->nextByCycleId[cycleId]);
+    TRAIL_SET_POINTER(&state->previous, face->previousByCycleId[cycleId]);
   }
 
   if (face->colors != 0 && face->colors != (NFACES - 1)) {
-    assert(face->next != Faces);
-    assert(face->previous != Faces);
+    assert(state->next != Faces);
+    assert(state->previous != Faces);
   }
 
   CHECK_FAILURE(
@@ -188,6 +251,37 @@ FAILURE dynamicFaceChoice(FACE face, int depth)
   return NULL;
 }
 
+static FAILURE dynamicFaceCheckVertices(FACE face, int depth)
+{
+  CYCLE cycle = FACE_STATE(face)->cycle;
+  FAILURE failure;
+
+  CHECK_FAILURE(dynamicCheckFacePoints(face, cycle, depth));
+  CHECK_FAILURE(dynamicCheckEdgeCurvesAndCorners(face, cycle, depth));
+  CHECK_FAILURE(dynamicPropagateFaceChoices(face, cycle, depth));
+
+  return NULL;
+}
+
+static FAILURE dynamicFacePropagateAll(void)
+{
+  FAILURE failure;
+  for (; Propagated < PendingLength; Propagated++) {
+    CHECK_FAILURE(dynamicFaceCheckVertices(Pending[Propagated].face,
+                                           Pending[Propagated].depth));
+    CHECK_FAILURE(dynamicFaceRestrictNeighbors(Pending[Propagated].face,
+                                               Pending[Propagated].depth));
+  }
+  return NULL;
+}
+
+FAILURE dynamicFacePropagate(void)
+{
+  FAILURE failure = dynamicFacePropagateAll();
+  PendingLength = Propagated = 0;
+  return failure;
+}
+
 FAILURE dynamicFaceBacktrackableChoice(FACE face)
 {
   FAILURE failure;
@@ -195,13 +289,15 @@ FAILURE dynamicFaceBacktrackableChoice(FACE face)
   uint64 cycleId;
   CycleGuessCounterIPC++;
   ColorCompletedState = 0;
-  assert(face->cycle != NULL);
-  cycleId = face->cycle - Cycles;
+  assert(FACE_STATE(face)->cycle != NULL);
+  cycleId = FACE_STATE(face)->cycle - Cycles;
   assert(cycleId < NCYCLES);
-  assert(cycleSetMember(cycleId, face->possibleCycles));
+  assert(cycleSetMember(cycleId, FACE_STATE(face)->possibleCycles));
+  dynamicFaceDequeue(face);
   dynamicSetFaceCycleSetToSingleton(face, cycleId);
 
-  failure = dynamicFaceChoice(face, 0);
+  dynamicFaceChoice(face, 0);
+  failure = dynamicFacePropagate();
   if (failure != NULL) {
     return failure;
   }
@@ -217,18 +313,35 @@ FAILURE dynamicFaceBacktrackableChoice(FACE face)
   return NULL;
 }
 
+/*
+ * Chooses the face, without a cycle, with the fewest possible cycles, and
+ * the lowest colors among those. These are the lowest bits of the first
+ * non-empty bucket of the queue of faces to choose, see dynamicface.c.
+ */
 FACE searchChooseNextFace(void)
 {
-  FACE face = NULL;
-  int64_t min = NCYCLES + 1;
-  int i;
-  for (i = 0; i < NFACES; i++) {
-    if ((int64_t)Faces[i].cycleSetSize < min && Faces[i].cycle == NULL) {
-      min = (int64_t)Faces[i].cycleSetSize;
-      face = Faces + i;
+  uint64 i, j, size;
+  uint_trail* bucket;
+  for (i = 0; i < SIZESET_LENGTH; i++) {
+    if (Context.sizesNonEmpty[i] == 0) {
+      continue;
+    }
+    size = i * BITS_PER_WORD + __builtin_ctzll(Context.sizesNonEmpty[i]);
+    bucket = Context.facesBySize[size];
+    for (j = 0; bucket[j] == 0; j++) {
+      assert(j + 1 < FACESET_LENGTH);
     }
+    return Faces + j * BITS_PER_WORD + __builtin_ctzll(bucket[j]);
   }
-  return face;
+  return NULL;
+}
+
+/* The cycles left are not tried, so the next try of the face starts again. */
+static void dynamicSkipFace(int round, int choice)
+{
+  (void)choice;
+  FACE_STATE(facesInOrderOfChoice[round])->cycle = NULL;
 }
 
-struct predicate VennPredicate = {"Venn", dynamicTryFace, dynamicRetryFace};
+struct predicate VennPredicate = {"Venn", dynamicTryFace, dynamicRetryFace,
+                                  dynamicSkipFace};
@@ -2,6 +2,7 @@
 
 #include "vertex.h"
 
+#include "context.h"
 #include "trail.h"
 #include "utils.h"
 
@@ -35,6 +36,7 @@ static VERTEX getOrInitializeVertex(COLORSET colorsOfFace, COLOR primary,
     VertexAllUVertices[NextUVertexId].primary = primary;
     VertexAllUVertices[NextUVertexId].secondary = secondary;
     VertexAllUVertices[NextUVertexId].colors = 1u << primary | 1u << secondary;
+    VertexAllUVertices[NextUVertexId].id = NextUVertexId;
     NextUVertexId++;
   }
   return AllUPointPointers[outsideColor][primary][secondary];
@@ -104,10 +106,10 @@ static FAILURE findCornersByTraversal(EDGE start, int depth,
   COLORSET notMyColor = ~(1u << start->color), passed = 0,
            outside = ~start->colors;
   int counter = 0;
-  assert(start->reversed->to == NULL ||
+  assert(EDGE_TO(start->reversed) == NULL ||
          (start->colors & notMyColor) == ((NFACES - 1) & notMyColor));
   do {
-    CURVELINK p = current->to;
+    CURVELINK p = EDGE_TO(current);
     if (detectCornerAndUpdateCrossingSets(p->vertex->colors & notMyColor,
                                           &outside, &passed)) {
       if (counter >= MAX_CORNERS) {
@@ -116,7 +118,7 @@ static FAILURE findCornersByTraversal(EDGE start, int depth,
       cornersReturn[counter++] = current;
     }
     current = p->next;
-  } while (current->to != NULL && current != start);
+  } while (EDGE_TO(current) != NULL && current != start);
   while (counter < MAX_CORNERS) {
     cornersReturn[counter++] = NULL;
   }
@@ -183,7 +185,7 @@ FAILURE vertexCornerCheck(EDGE start, int depth)
   return NULL;
 #else
   EDGE ignore[MAX_CORNERS * 100];
-  if (start->reversed->to != NULL) {
+  if (EDGE_TO(start->reversed) != NULL) {
     start = vertexGetCentralEdge(start->color);
   }
   return findCornersByTraversal(start, depth, ignore);
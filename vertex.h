@@ -61,10 +61,8 @@ struct Vertex {
   /* A bit set of the two colors. */
   MEMO COLORSET colors;
 
-  /* The first of the two lines at this vertex.
-     Lines count from 1; 0 means not yet set.
-   */
-  uint_trail lineId;
+  /* The index of this vertex, for its DYNAMIC lineId: see VERTEX_LINE_ID. */
+  MEMO uint32_t id;
 };
 
 /**
@@ -73,22 +71,13 @@ struct Vertex {
  * A face is a region enclosed by edges of different colors.
  */
 struct face {
-  /* cycle must be null if cycleSetSize is not 1. */
-  DYNAMIC struct facialCycle* cycle;
-
-  /* Links to previous and next faces with the same number of colors. */
-  DYNAMIC FACE previous;
-  DYNAMIC FACE next;
+  /* The DYNAMIC fields, cycle, previous, next, cycleSetSize and
+   * possibleCycles, are in the search context: see FACE_STATE in context.h.
+   */
 
   /* The colors that define this face */
   MEMO COLORSET colors; /* holds up to NFACES */
 
-  /* Number of possible cycles for this face */
-  DYNAMIC uint_trail cycleSetSize; /* holds up to NCYCLES */
-
-  /* Set of possible cycles for this face */
-  DYNAMIC CYCLESET_DECLARE possibleCycles;
-
   /* Array of adjacent faces, indexed by color */
   MEMO struct face* adjacentFaces[NCOLORS];
 
@@ -16,7 +16,6 @@
 
 /* Search algorithm internals */
 extern FACE searchChooseNextFace(void);         /* Face selection algorithm */
-extern int searchCountVariations(void);         /* Count available variations */
 
 /* S6 signature functions */
 extern PERMUTATION s6Automorphism(CYCLE_ID cycleId); /* Get automorphism for cycle */
@@ -26,7 +25,10 @@ extern char *s6SignatureToLongString(SIGNATURE signature); /* Convert to detaile
 /* These cycle sets are already declared in cycleset.h but needed for tests */
 
 /* Trail system */
-extern TRAIL Trail; /* Global trail for backtracking */
+extern THREAD_LOCAL TRAIL Trail; /* Global trail for backtracking */
 extern bool trailRewindTo(TRAIL backtrackPoint); /* Rewind trail to point */
 
+/* Checkpoints */
+extern int CheckpointSeconds; /* Between checkpoints, see checkpoint.c */
+
 #endif  /* VISIBLE_FOR_TESTING_H */
\ No newline at end of file
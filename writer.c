@@ -0,0 +1,193 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#define _GNU_SOURCE
+#include "writer.h"
+
+#include "common.h"
+#include "context.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define QUEUE_MASK (WRITER_QUEUE_LENGTH - 1)
+#define MAX_WRITER_THREADS 64
+
+/* A solution whose variations are being written. */
+struct writerSolution {
+  struct searchContext context;
+  char prefix[1024]; /* CurrentPrefixIPC */
+  int levels;        /* LevelsIPC */
+  uint64 id;         /* Distinguishes successive solutions of the thread */
+  int queued;        /* Variations queued */
+  sem_t written;     /* Posted as each variation is written */
+};
+
+/*
+ * The queue is a bounded ring in which each cell has a sequence number, as
+ * in Vyukov's bounded MPMC queue. Positions are claimed with atomic
+ * increments of Tail (by the search threads) and of Head (by the writer
+ * threads). The cell at position pos may be filled when its sequence is
+ * pos, and may be written out when its sequence is pos + 1; it is released
+ * for the next time round the ring, as pos + WRITER_QUEUE_LENGTH, only
+ * once its file has been written.
+ *
+ * The semaphores are only for sleeping: Items counts the cells that have
+ * been filled, and Slots the cells that are free. A cell with a NULL
+ * solution tells a writer thread to stop.
+ */
+struct writerCell {
+  atomic_size_t sequence;
+  struct writerSolution* solution;
+  int variationNumber;
+  EDGE corners[NCOLORS][MAX_CORNERS];
+};
+
+static struct writerCell Queue[WRITER_QUEUE_LENGTH];
+static atomic_size_t Head;
+static atomic_size_t Tail;
+static sem_t Items;
+static sem_t Slots;
+static pthread_t Threads[MAX_WRITER_THREADS];
+static int NumberOfWriterThreads = 0;
+
+/* The solution of this search thread whose variations are being queued. */
+static THREAD_LOCAL struct writerSolution WriterSolution;
+
+static void semaphoreWait(sem_t* semaphore)
+{
+  while (sem_wait(semaphore) != 0) {
+    if (errno != EINTR) {
+      perror("sem_wait");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+static struct writerCell* waitForSequence(size_t pos, size_t sequence)
+{
+  struct writerCell* cell = &Queue[pos & QUEUE_MASK];
+  while (atomic_load_explicit(&cell->sequence, memory_order_acquire) !=
+         sequence) {
+    sched_yield();
+  }
+  return cell;
+}
+
+static void enqueue(struct writerSolution* solution, int variationNumber,
+                    EDGE (*corners)[3])
+{
+  size_t pos;
+  struct writerCell* cell;
+  semaphoreWait(&Slots);
+  pos = atomic_fetch_add(&Tail, 1);
+  cell = waitForSequence(pos, pos);
+  cell->solution = solution;
+  cell->variationNumber = variationNumber;
+  if (corners != NULL) {
+    memcpy(cell->corners, corners, sizeof(cell->corners));
+  }
+  atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+  sem_post(&Items);
+}
+
+static void* writerThread(void* unused)
+{
+  struct writerSolution* current = NULL;
+  uint64 currentId = 0;
+  (void)unused;
+  for (;;) {
+    struct writerSolution* solution;
+    size_t pos;
+    struct writerCell* cell;
+    semaphoreWait(&Items);
+    pos = atomic_fetch_add(&Head, 1);
+    cell = waitForSequence(pos, pos + 1);
+    solution = cell->solution;
+    if (solution == NULL) {
+      atomic_store_explicit(&cell->sequence, pos + WRITER_QUEUE_LENGTH,
+                            memory_order_release);
+      sem_post(&Slots);
+      break;
+    }
+    if (solution != current || solution->id != currentId) {
+      contextRestore(&solution->context);
+      strcpy(CurrentPrefixIPC, solution->prefix);
+      LevelsIPC = solution->levels;
+      current = solution;
+      currentId = solution->id;
+    }
+    VariationNumberIPC = cell->variationNumber;
+    graphmlWriteVariation(cell->corners);
+    freeAll();
+    sem_post(&solution->written);
+    atomic_store_explicit(&cell->sequence, pos + WRITER_QUEUE_LENGTH,
+                          memory_order_release);
+    sem_post(&Slots);
+  }
+  releaseMemory();
+  return NULL;
+}
+
+void writerStart(int numberOfThreads)
+{
+  assert(NumberOfWriterThreads == 0);
+  if (numberOfThreads > MAX_WRITER_THREADS) {
+    numberOfThreads = MAX_WRITER_THREADS;
+  }
+  for (size_t i = 0; i < WRITER_QUEUE_LENGTH; i++) {
+    atomic_init(&Queue[i].sequence, i);
+  }
+  atomic_init(&Head, 0);
+  atomic_init(&Tail, 0);
+  sem_init(&Items, 0, 0);
+  sem_init(&Slots, 0, WRITER_QUEUE_LENGTH);
+  for (int i = 0; i < numberOfThreads; i++) {
+    if (pthread_create(&Threads[i], NULL, writerThread, NULL) != 0) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  NumberOfWriterThreads = numberOfThreads;
+}
+
+void writerStop(void)
+{
+  for (int i = 0; i < NumberOfWriterThreads; i++) {
+    enqueue(NULL, 0, NULL);
+  }
+  for (int i = 0; i < NumberOfWriterThreads; i++) {
+    pthread_join(Threads[i], NULL);
+  }
+  sem_destroy(&Items);
+  sem_destroy(&Slots);
+  NumberOfWriterThreads = 0;
+}
+
+void writerBeginSolution(void)
+{
+  if (WriterSolution.id == 0) {
+    sem_init(&WriterSolution.written, 0, 0);
+  }
+  assert(WriterSolution.queued == 0);
+  contextClone(&WriterSolution.context);
+  strcpy(WriterSolution.prefix, CurrentPrefixIPC);
+  WriterSolution.levels = LevelsIPC;
+  WriterSolution.id++;
+}
+
+void writerWrite(EDGE (*corners)[3])
+{
+  WriterSolution.queued++;
+  enqueue(&WriterSolution, VariationNumberIPC - 1, corners);
+}
+
+void writerFlush(void)
+{
+  for (; WriterSolution.queued > 0; WriterSolution.queued--) {
+    semaphoreWait(&WriterSolution.written);
+  }
+}
@@ -0,0 +1,33 @@
+/* Copyright (C) 2025 Jeremy J. Carroll. See LICENSE for details. */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "edge.h"
+
+/**
+ * Asynchronous GraphML writing (-w). The search thread queues each
+ * variation, as its corners, and writer threads format it and write its
+ * file. The queue is a bounded lock-free ring, shared by all the search
+ * threads of -T; when it is full, the search waits.
+ *
+ * The GraphML depends on the solution as well as the corners, so each
+ * search thread snapshots the solution before its variations are queued,
+ * and waits for them all to be written before it moves on.
+ */
+
+#define WRITER_QUEUE_LENGTH 256 /* A power of two */
+
+/* Starts the writer threads, before the search. */
+extern void writerStart(int numberOfThreads);
+/* Writes everything that is queued, and stops the writer threads. */
+extern void writerStop(void);
+
+/* Snapshots the current solution, before its variations are queued. */
+extern void writerBeginSolution(void);
+/* Queues variation VariationNumberIPC of the current solution. */
+extern void writerWrite(EDGE (*corners)[3]);
+/* Waits for the variations of the current solution to be written. */
+extern void writerFlush(void);
+
+#endif /* WRITER_H */